@@ -0,0 +1,63 @@
+#include "bus_scheduler.h"
+
+namespace devicestate {
+
+    void BusScheduler::post(BusJob job, uint32_t release_ms, uint32_t deadline_ms) {
+        if (job >= BusJob_Count) return;
+        Slot& slot = slots_[job];
+        slot.pending = true;
+        slot.release_ms = release_ms;
+        slot.deadline_ms = deadline_ms;
+    }
+
+    void BusScheduler::cancel(BusJob job) {
+        if (job >= BusJob_Count) return;
+        slots_[job].pending = false;
+    }
+
+    bool BusScheduler::isPending(BusJob job) const {
+        return job < BusJob_Count && slots_[job].pending;
+    }
+
+    BusJob BusScheduler::next(uint32_t now_ms) const {
+        BusJob best = BusJob_None;
+        for (uint8_t i = 0; i < BusJob_Count; i++) {
+            const Slot& slot = slots_[i];
+            // signed differences keep the comparisons right across the millis() wraparound
+            if (!slot.pending || static_cast<int32_t>(now_ms - slot.release_ms) < 0) continue;
+            if (best == BusJob_None) {
+                best = static_cast<BusJob>(i);
+                continue;
+            }
+            const int32_t delta = static_cast<int32_t>(slot.deadline_ms - slots_[best].deadline_ms);
+            if (delta < 0 || (delta == 0 && priorityOf(static_cast<BusJob>(i)) < priorityOf(best))) {
+                best = static_cast<BusJob>(i);
+            }
+        }
+        return best;
+    }
+
+    TxPriority BusScheduler::priorityOf(BusJob job) {
+        switch (job) {
+        case BusJob_Settings:
+        case BusJob_RunStates:
+            return TxPriority_Control;
+        case BusJob_RemoteTemp:
+            return TxPriority_RemoteTemp;
+        default:
+            return TxPriority_Info;
+        }
+    }
+
+    const char* BusScheduler::nameOf(BusJob job) {
+        switch (job) {
+        case BusJob_Settings: return "settings write";
+        case BusJob_RunStates: return "run states write";
+        case BusJob_RemoteTemp: return "remote temperature";
+        case BusJob_ConfirmRead: return "settings read-back";
+        case BusJob_InfoPoll: return "info poll";
+        default: return "none";
+        }
+    }
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "transmit_queue.h"
+
+namespace devicestate {
+
+    /**
+     * Kinds of transactions competing for the CN105 bus.
+     */
+    enum BusJob : uint8_t {
+        BusJob_Settings = 0,          // 0x41 wanted settings write
+        BusJob_RunStates,             // 0x41/0x08 wanted run states write
+        BusJob_RemoteTemp,            // 0x41/0x07 remote temperature
+        BusJob_ConfirmRead,           // 0x42/0x02 read-back of the last settings write
+        BusJob_InfoPoll,              // next 0x42 info request of the polling cycle
+        BusJob_Count,
+        BusJob_None = 0xFF
+    };
+
+    /**
+     * @class BusScheduler
+     * @brief Earliest-deadline-first arbitration of the CN105 bus.
+     *
+     * Every pending transaction has a release time (not sent before) and a
+     * deadline; among the released ones the earliest deadline goes first, ties
+     * are broken by the TxPriority of the frame. One slot per job kind, so no
+     * allocation: posting a job again only moves its times.
+     */
+    class BusScheduler {
+    public:
+        /**
+         * @brief Marks a job pending
+         * @param job Kind of transaction
+         * @param release_ms Earliest time the job may be sent (millis)
+         * @param deadline_ms Time by which it should be sent (millis)
+         */
+        void post(BusJob job, uint32_t release_ms, uint32_t deadline_ms);
+
+        void cancel(BusJob job);
+        bool isPending(BusJob job) const;
+
+        /**
+         * @brief Picks the released job with the earliest deadline
+         * @return The job, BusJob_None when nothing is released at now_ms
+         */
+        BusJob next(uint32_t now_ms) const;
+
+        static TxPriority priorityOf(BusJob job);
+        static const char* nameOf(BusJob job);
+
+    private:
+        struct Slot {
+            bool pending = false;
+            uint32_t release_ms = 0;
+            uint32_t deadline_ms = 0;
+        };
+
+        Slot slots_[BusJob_Count];
+    };
+
+}
@@ -38,6 +38,7 @@ from esphome.const import (
     UNIT_WATT,
     UNIT_KILOWATT_HOURS,
     UNIT_HOUR,
+    UNIT_MILLISECOND,
 )
 from esphome.core import CORE, coroutine
 
@@ -51,6 +52,24 @@ CONF_SUPPORTS = "supports"
 CONF_SUPPORTS_HORIZONTAL_VANE_MODE = "horizontal_vane_mode"
 CONF_REMOTE_TEMP_TIMEOUT = "remote_temperature_timeout"
 CONF_DEBOUNCE_DELAY = "debounce_delay"
+CONF_REMOTE_TEMP_FAST_DELTA = "remote_temperature_fast_delta"
+CONF_REMOTE_TEMP_FAST_INTERVAL = "remote_temperature_fast_interval"
+CONF_REMOTE_TEMP_DITHERING = "remote_temperature_dithering"
+CONF_INTERVAL = "interval"
+CONF_REMOTE_TEMP_FILTER = "remote_temperature_filter"
+CONF_OUTLIER_DELTA = "outlier_delta"
+CONF_MEDIAN_WINDOW = "median_window"
+CONF_EMA_ALPHA = "ema_alpha"
+CONF_MIN_CHANGE = "min_change"
+CONF_PUBLISH_HEARTBEAT = "publish_heartbeat"
+CONF_PUBLISH_DEADBANDS = "publish_deadbands"
+CONF_PUBLISH_BUDGET = "publish_budget"
+CONF_MIN_FRAME_INTERVAL = "min_frame_interval"
+CONF_MAX_FRAME_INTERVAL = "max_frame_interval"
+CONF_LATENCY_SENSORS = "latency_sensors"
+CONF_ADAPTIVE_POLLING = "adaptive_polling"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_MAX_INTERVAL = "max_interval"
 
 CONF_CONTROL_PARAMETERS = "control_parameters"
 CONF_KP = "kp"
@@ -92,6 +111,20 @@ CONF_REMOTE_OPERATING_TIMEOUT = "remote_temperature_operating_timeout_minutes"
 CONF_REMOTE_IDLE_TIMEOUT = "remote_temperature_idle_timeout_minutes"
 CONF_REMOTE_PING_TIMEOUT = "remote_temperature_ping_timeout_minutes"
 
+devicestate_ns = cg.global_ns.namespace("devicestate")
+PublishedSensor = devicestate_ns.enum("PublishedSensor")
+# sensors with a configurable publish deadband
+PUBLISH_DEADBAND_SENSORS = {
+    "set_point": PublishedSensor.PublishedSensor_SetPoint,
+    "current_temperature": PublishedSensor.PublishedSensor_CurrentTemperature,
+    "outside_temperature": PublishedSensor.PublishedSensor_OutsideTemperature,
+    "compressor_frequency": PublishedSensor.PublishedSensor_CompressorFrequency,
+    "input_power": PublishedSensor.PublishedSensor_InputPower,
+    "kwh": PublishedSensor.PublishedSensor_KWh,
+    "runtime_hours": PublishedSensor.PublishedSensor_RuntimeHours,
+    "pid_set_point_correction": PublishedSensor.PublishedSensor_PidSetPointCorrection,
+}
+
 MitsubishiHeatPump = cg.global_ns.class_(
     "MitsubishiHeatPump", climate.Climate, cg.Component, uart.UARTDevice
 )
@@ -106,7 +139,16 @@ SELECT_SCHEMA = select.select_schema(MitsubishiACSelect).extend(
     {cv.GenerateID(CONF_ID): cv.declare_id(MitsubishiACSelect)}
 )
 
-CONFIG_SCHEMA = climate.climate_schema(MitsubishiHeatPump).extend(
+def validate_frame_intervals(config):
+    if config[CONF_MIN_FRAME_INTERVAL] > config[CONF_MAX_FRAME_INTERVAL]:
+        raise cv.Invalid(
+            f"{CONF_MIN_FRAME_INTERVAL} must not be greater than {CONF_MAX_FRAME_INTERVAL}",
+            path=[CONF_MIN_FRAME_INTERVAL],
+        )
+    return config
+
+
+CONFIG_SCHEMA = cv.All(climate.climate_schema(MitsubishiHeatPump).extend(
     {
         cv.GenerateID(): cv.declare_id(MitsubishiHeatPump),
         cv.GenerateID(CONF_UART_ID): cv.use_id(uart.UARTComponent),
@@ -127,6 +169,69 @@ CONFIG_SCHEMA = climate.climate_schema(MitsubishiHeatPump).extend(
         cv.Optional(CONF_DEBOUNCE_DELAY, default="100ms"): cv.All(
             cv.update_interval
         ),
+        # Remote temperature changes of at least this much are sent between two info requests
+        # instead of with the polling cycle (0 disables), at most once per fast interval
+        cv.Optional(CONF_REMOTE_TEMP_FAST_DELTA, default=1.0): cv.All(
+            cv.float_, cv.Range(min=0.0, max=10.0)
+        ),
+        cv.Optional(CONF_REMOTE_TEMP_FAST_INTERVAL, default="10s"): cv.positive_time_period_milliseconds,
+        # Send the remote temperature alternating between the two closest half degrees so that
+        # the unit sees the exact reading on average, one step per interval at most
+        cv.Optional(CONF_REMOTE_TEMP_DITHERING): cv.Schema(
+            {
+                cv.Optional(CONF_INTERVAL, default="30s"): cv.All(
+                    cv.positive_time_period_milliseconds, cv.Range(min=cv.TimePeriod(seconds=5), max=cv.TimePeriod(minutes=10))
+                ),
+            }
+        ),
+        # Filter of the remote temperature samples before they are sent and published: samples
+        # further than outlier_delta from the recent median are dropped (0 keeps them all),
+        # then median of median_window samples, EMA, and only changes of min_change go through
+        cv.Optional(CONF_REMOTE_TEMP_FILTER): cv.Schema(
+            {
+                cv.Optional(CONF_OUTLIER_DELTA, default=3.0): cv.All(
+                    cv.float_, cv.Range(min=0.0, max=20.0)
+                ),
+                cv.Optional(CONF_MEDIAN_WINDOW, default=3): cv.int_range(min=1, max=9),
+                cv.Optional(CONF_EMA_ALPHA, default=0.5): cv.All(
+                    cv.float_, cv.Range(min=0.01, max=1.0)
+                ),
+                cv.Optional(CONF_MIN_CHANGE, default=0.1): cv.All(
+                    cv.float_, cv.Range(min=0.0, max=2.0)
+                ),
+            }
+        ),
+        # Bounds of the gap kept between two frames, learned from the heatpump response time
+        cv.Optional(CONF_MIN_FRAME_INTERVAL, default="100ms"): cv.All(
+            cv.positive_time_period_milliseconds, cv.Range(max=cv.TimePeriod(milliseconds=1000))
+        ),
+        cv.Optional(CONF_MAX_FRAME_INTERVAL, default="300ms"): cv.All(
+            cv.positive_time_period_milliseconds, cv.Range(max=cv.TimePeriod(milliseconds=2000))
+        ),
+        # Poll each info request less often while its answer does not change, back to
+        # min_interval as soon as it does (writes always read their result back on the next cycle)
+        cv.Optional(CONF_ADAPTIVE_POLLING): cv.Schema(
+            {
+                cv.Optional(CONF_MIN_INTERVAL, default="0ms"): cv.positive_time_period_milliseconds,
+                cv.Optional(CONF_MAX_INTERVAL, default="30s"): cv.All(
+                    cv.positive_time_period_milliseconds, cv.Range(min=cv.TimePeriod(seconds=1), max=cv.TimePeriod(minutes=5))
+                ),
+            }
+        ),
+        # Sensors are published when they change past their deadband, and again every
+        # heartbeat while they do not (0s: only on change)
+        cv.Optional(CONF_PUBLISH_HEARTBEAT, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_PUBLISH_DEADBANDS): cv.Schema(
+            {cv.Optional(name): cv.positive_float for name in PUBLISH_DEADBAND_SENSORS}
+        ),
+        # Time the state publication that follows each cycle may take in one loop iteration,
+        # the rest is carried over to the next ones (0us: all at once); checked between steps,
+        # so a single step (the climate entity update mostly) may still overrun it
+        cv.Optional(CONF_PUBLISH_BUDGET, default="5ms"): cv.All(
+            cv.positive_time_period_microseconds, cv.Range(max=cv.TimePeriod(milliseconds=30))
+        ),
+        # Diagnostic sensors with the p50/p95/max round-trip of the heatpump answers
+        cv.Optional(CONF_LATENCY_SENSORS, default=False): cv.boolean,
         # Add selects for vertical and horizontal vane positions
         cv.Optional(CONF_HORIZONTAL_SWING_SELECT): SELECT_SCHEMA,
         cv.Optional(CONF_VERTICAL_SWING_SELECT): SELECT_SCHEMA,
@@ -156,7 +261,7 @@ CONFIG_SCHEMA = climate.climate_schema(MitsubishiHeatPump).extend(
             }
         ),
     }
-).extend(cv.COMPONENT_SCHEMA)
+).extend(cv.COMPONENT_SCHEMA), validate_frame_intervals)
 
 @coroutine
 def to_code(config):
@@ -229,6 +334,22 @@ def to_code(config):
 
     cg.add(var.set_remote_temp_timeout(config[CONF_REMOTE_TEMP_TIMEOUT]))
     cg.add(var.set_debounce_delay(config[CONF_DEBOUNCE_DELAY]))
+    cg.add(var.set_remote_temp_fast_path(config[CONF_REMOTE_TEMP_FAST_DELTA], config[CONF_REMOTE_TEMP_FAST_INTERVAL]))
+    if CONF_REMOTE_TEMP_DITHERING in config:
+        cg.add(var.set_remote_temp_dithering(config[CONF_REMOTE_TEMP_DITHERING][CONF_INTERVAL]))
+    if CONF_REMOTE_TEMP_FILTER in config:
+        remote_filter = config[CONF_REMOTE_TEMP_FILTER]
+        cg.add(var.set_remote_temp_filter(remote_filter[CONF_MEDIAN_WINDOW], remote_filter[CONF_OUTLIER_DELTA],
+                                          remote_filter[CONF_EMA_ALPHA], remote_filter[CONF_MIN_CHANGE]))
+    cg.add(var.set_publish_heartbeat(config[CONF_PUBLISH_HEARTBEAT]))
+    cg.add(var.set_publish_budget(config[CONF_PUBLISH_BUDGET]))
+    for name, deadband in config.get(CONF_PUBLISH_DEADBANDS, {}).items():
+        cg.add(var.set_publish_deadband(PUBLISH_DEADBAND_SENSORS[name], deadband))
+    cg.add(var.set_min_frame_interval(config[CONF_MIN_FRAME_INTERVAL]))
+    cg.add(var.set_max_frame_interval(config[CONF_MAX_FRAME_INTERVAL]))
+    if CONF_ADAPTIVE_POLLING in config:
+        polling = config[CONF_ADAPTIVE_POLLING]
+        cg.add(var.set_adaptive_polling(polling[CONF_MIN_INTERVAL], polling[CONF_MAX_INTERVAL]))
 
     if CONF_HORIZONTAL_SWING_SELECT in config:
         conf_item = config[CONF_HORIZONTAL_SWING_SELECT]
@@ -398,6 +519,21 @@ def to_code(config):
     })
     cg.add(var.set_device_set_point_sensor(device_set_point_sensor_var))
 
+    if config[CONF_LATENCY_SENSORS]:
+        for key, name in (("p50", "Response latency p50"), ("p95", "Response latency p95"), ("max", "Response latency max")):
+            latency_sensor_var = yield sensor.new_sensor({
+                CONF_ID: cv.declare_id(sensor.Sensor)(f"response_latency_{key}"),
+                CONF_NAME: name,
+                CONF_UNIT_OF_MEASUREMENT: UNIT_MILLISECOND,
+                CONF_STATE_CLASS: StateClasses.STATE_CLASS_MEASUREMENT,
+                CONF_ACCURACY_DECIMALS: 0,
+                CONF_FORCE_UPDATE: False,
+                CONF_DISABLED_BY_DEFAULT: False,
+                CONF_INTERNAL: False,
+                CONF_ENTITY_CATEGORY: cg.EntityCategory.ENTITY_CATEGORY_DIAGNOSTIC,
+            })
+            cg.add(getattr(var, f"set_response_latency_{key}_sensor")(latency_sensor_var))
+
     yield cg.register_component(var, config)
     yield climate.register_climate(var, config)
 
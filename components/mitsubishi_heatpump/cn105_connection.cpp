@@ -15,6 +15,8 @@ namespace devicestate {
 
     static const char* TAG = "CN105Connection"; // Logging tag
 
+    static const int FRAME_HEADER_LEN = 5;      // start, command, 0x01, 0x30, data length
+
     CN105Connection::CN105Connection(
                 IIODevice* io_device,
                 TimeoutCallback timeoutCallback,
@@ -81,7 +83,7 @@ namespace devicestate {
 
     bool CN105Connection::ensureActiveConnection() {
         if (this->isConnectionActive() && this->isUARTConnected_) {
-            if (CUSTOM_MILLIS - this->lastSend > 300) {        // we don't want to send too many packets
+            if (this->hasSendGapElapsed()) {  // we don't want to send too many packets
                 //this->cycleEnded();   // only if we let the cycle be interrupted to send wented settings
                 return true;
             } else {
@@ -118,7 +120,7 @@ namespace devicestate {
      * Initializes few variables
     */
     void CN105Connection::initBytePointer() {
-        this->foundStart = false;
+        this->decoderState = DecoderState::WAIT_START;
         this->bytesRead = 0;
         this->dataLength = -1;
         this->command = 0;
@@ -126,14 +128,14 @@ namespace devicestate {
 
     bool CN105Connection::checkSum() {
         // Bounds check: ensure we don't read past buffer
-        if (this->bytesRead >= MAX_DATA_BYTES || this->dataLength < 0 ||
-            (this->dataLength + 5) > MAX_DATA_BYTES) {
+        if (this->dataLength < 0 || (this->dataLength + 6) > MAX_DATA_BYTES ||
+            this->bytesRead < this->dataLength + 6) {
             ESP_LOGW("chkSum", "Invalid packet dimensions: bytesRead=%d dataLength=%d",
                      this->bytesRead, this->dataLength);
             return false;
         }
 
-        uint8_t packetCheckSum = storedInputData[this->bytesRead];
+        uint8_t packetCheckSum = storedInputData[this->dataLength + 5];
         uint8_t processedCS = 0;
 
         ESP_LOGV("chkSum", "controling chkSum should be: %02X ", packetCheckSum);
@@ -153,7 +155,7 @@ namespace devicestate {
             if (!this->isHeatpumpConnected_) {
                 ESP_LOGD(LOG_CONN_TAG, "Checksum KO during handshake (computed=%02X packet=%02X, cmd=0x%02X len=%d)",
                     processedCS, packetCheckSum, this->command, this->dataLength);
-                hpPacketDebug(this->storedInputData, this->bytesRead + 1, LOG_CONN_TAG);
+                hpPacketDebug(this->storedInputData, this->dataLength + 6, LOG_CONN_TAG);
             }
         }
 
@@ -179,6 +181,8 @@ namespace devicestate {
         ESP_LOGD(TAG, "disconnectUART()");
         this->isUARTConnected_ = false;
         this->firstRun = true;
+        // no ack will come for what was sent before
+        this->writes_.clear();
     }
 
     void CN105Connection::reconnectUART() {
@@ -241,73 +245,158 @@ namespace devicestate {
         return  (lrTimeMs < MAX_DELAY_RESPONSE_FACTOR * this->update_interval_);
     }
 
+    bool CN105Connection::canWrite(bool checkIsActive) {
+        return this->isUARTConnected_ && (this->isConnectionActive() || (!checkIsActive));
+    }
+
+    void CN105Connection::transmit(const uint8_t* packet, int length) {
+        ESP_LOGD(TAG, "writing packet...");
+        hpPacketDebug(packet, length, "WRITE");
+
+        // the whole frame goes to the UART FIFO in a single driver call
+        this->io_device_->write_array(packet, static_cast<size_t>(length));
+        this->capture_.record(FrameDirection_TX, packet, length, CUSTOM_MILLIS);
+
+        // Prevent sending wantedSettings too soon after writing for example the remote temperature update packet
+        this->lastSend = CUSTOM_MILLIS;
+        this->pacing_.onSent(packet, length, this->lastSend);
+        this->writes_.onSent(packet, length, this->lastSend);
+        if (this->sentCallback_) {
+            this->sentCallback_(packet, length);
+        }
+    }
+
+    void CN105Connection::enqueuePacket(const uint8_t* packet, int length, bool checkIsActive, uint32_t flushDelay) {
+        if (!this->tx_queue_.push(packet, length, checkIsActive)) {
+            return;
+        }
+        ESP_LOGD(TAG, "%d packet(s) waiting in transmit queue", this->tx_queue_.size());
+        timeoutCallback_("write", flushDelay, [this]() {
+            this->try_write_pending_packet();
+        });
+    }
+
+    /**
+     * Sends the next queued frame (highest priority first), one frame per call
+     * so the minimum gap between two frames is respected.
+    */
     void CN105Connection::try_write_pending_packet() {
-        if (!this->has_pending_packet_) return;
+        const QueuedPacket* next = this->tx_queue_.peek();
+        if (next == nullptr) return;
+
         if (!this->isUARTConnected_) {
             this->reconnectUART();
             timeoutCallback_("write", 2000, [this]() { this->try_write_pending_packet(); });
             return;
         }
-        this->writePacket(this->pending_packet_, this->pending_packet_len_, this->pending_check_is_active_);
-        this->has_pending_packet_ = false;
-    }
 
-    void CN105Connection::writePacket(uint8_t* packet, int length, bool checkIsActive) {
-        if ((this->isUARTConnected_) &&
-            (this->isConnectionActive() || (!checkIsActive))) {
+        if (!this->canWrite(next->checkIsActive)) {
+            ESP_LOGW(TAG, "connection not active, delaying %d queued packet(s)...", this->tx_queue_.size());
+            this->reconnectUART();
+            timeoutCallback_("write", 4000, [this]() { this->try_write_pending_packet(); });
+            return;
+        }
 
-            ESP_LOGD(TAG, "writing packet...");
-            hpPacketDebug(packet, length, "WRITE");
+        const uint32_t elapsed = CUSTOM_MILLIS - this->lastSend;
+        const uint32_t gap = this->pacing_.getSendGap();
+        if (elapsed < gap) {
+            timeoutCallback_("write", gap - elapsed, [this]() { this->try_write_pending_packet(); });
+            return;
+        }
 
-            for (int i = 0; i < length; i++) {
-                this->io_device_->write((uint8_t)packet[i]);
-            }
+        QueuedPacket queued;
+        this->tx_queue_.pop(queued);
+        this->transmit(queued.packet, queued.length);
 
-            // Prevent sending wantedSettings too soon after writing for example the remote temperature update packet
-            this->lastSend = CUSTOM_MILLIS;
+        if (!this->tx_queue_.isEmpty()) {
+            timeoutCallback_("write", this->pacing_.getSendGap(), [this]() { this->try_write_pending_packet(); });
+        }
+    }
 
-        } else {
-            ESP_LOGW(TAG, "could not write as asked, because UART is not connected");
-            this->reconnectUART();
-            ESP_LOGW(TAG, "delaying packet writing because we need to reconnect first...");
-            if (length > PACKET_LEN) {
-                ESP_LOGE(TAG, "Packet length %d exceeds PACKET_LEN %d, dropping.", length, PACKET_LEN);
-                return;
+    bool CN105Connection::writePacket(uint8_t* packet, int length, bool checkIsActive) {
+        if (this->canWrite(checkIsActive)) {
+            const uint32_t elapsed = CUSTOM_MILLIS - this->lastSend;
+            const uint32_t gap = this->pacing_.getSendGap();
+            // the CONNECT packet (checkIsActive=false) never waits behind queued frames
+            if (!checkIsActive || (this->tx_queue_.isEmpty() && elapsed >= gap)) {
+                this->transmit(packet, length);
+                return true;
             }
 
-            memcpy(this->pending_packet_, packet, static_cast<size_t>(length));
-            this->pending_packet_len_ = length;
-            this->pending_check_is_active_ = checkIsActive;
-            this->has_pending_packet_ = true;
-
-            timeoutCallback_("write", 4000, [this]() {
-                this->try_write_pending_packet();
-            });
+            // frames are already waiting, or the last one is too recent: queue this one so the
+            // priority order and the gap between frames are kept whatever the caller checked
+            ESP_LOGD(TAG, "transmit queue not empty or gap not elapsed, queueing packet...");
+            this->enqueuePacket(packet, length, checkIsActive, elapsed < gap ? gap - elapsed : 0);
+            return false;
         }
+
+        ESP_LOGW(TAG, "could not write as asked, because UART is not connected");
+        this->reconnectUART();
+        ESP_LOGW(TAG, "delaying packet writing because we need to reconnect first...");
+        this->enqueuePacket(packet, length, checkIsActive, 4000);
+        return false;
     }
 
-    void CN105Connection::checkHeader(uint8_t inputData) {
-        if (this->bytesRead == 4) {
-            if (storedInputData[2] == HEADER[2] && storedInputData[3] == HEADER[3]) {
-                ESP_LOGV("Header", "header matches HEADER");
-                ESP_LOGV("Header", "[%02X] (%02X) %02X %02X [%02X]<-- header", storedInputData[0], storedInputData[1], storedInputData[2], storedInputData[3], storedInputData[4]);
-                ESP_LOGD("Header", "command: (%02X) data length: [%02X]<-- header", storedInputData[1], storedInputData[4]);
-                this->command = storedInputData[1];
-            }
-            this->dataLength = storedInputData[4];
+    bool CN105Connection::isQueued(uint8_t command, uint8_t code) {
+        return this->tx_queue_.contains(command, code);
+    }
+
+    bool CN105Connection::checkHeader() {
+        ESP_LOGV("Header", "[%02X] (%02X) %02X %02X [%02X]<-- header", storedInputData[0], storedInputData[1], storedInputData[2], storedInputData[3], storedInputData[4]);
+        if (storedInputData[2] != HEADER[2] || storedInputData[3] != HEADER[3]) {
+            ESP_LOGW("Header", "header does not match HEADER: %02X %02X", storedInputData[2], storedInputData[3]);
+            return false;
         }
+
+        if ((storedInputData[4] + 6) > MAX_DATA_BYTES) {
+            ESP_LOGW("Decoder", "declared data length %d too large", storedInputData[4]);
+            return false;
+        }
+
+        ESP_LOGD("Header", "command: (%02X) data length: [%02X]<-- header", storedInputData[1], storedInputData[4]);
+        this->command = storedInputData[1];
+        this->dataLength = storedInputData[4];
+        return true;
     }
 
     void CN105Connection::updateSuccess() {
-        ESP_LOGD(LOG_ACK, "Last heatpump data update successful!");
-        // nothing can be done here because we have no mean to know wether it is an external temp ack
-        // or a wantedSettings update ack
+        // the ack carries nothing about the write: the heatpump answers in order, so it is the oldest one
+        WriteType type;
+        if (this->writes_.onAck(CUSTOM_MILLIS, &type)) {
+            ESP_LOGD(LOG_ACK, "%s acknowledged", WriteTracker::nameOf(type));
+        } else {
+            ESP_LOGW(LOG_ACK, "Ack received but no write was waiting for it");
+        }
+    }
+
+    /**
+     * Writes without ack are sent again, only them; a remote temperature already
+     * followed by a newer one is not, control writes only carry the fields that
+     * changed so they always are.
+    */
+    void CN105Connection::expireWrites() {
+        InFlightWrite lost;
+        while (this->writes_.expire(CUSTOM_MILLIS, WRITE_ACK_TIMEOUT_MS, lost)) {
+            const bool superseded = lost.type == WriteType_RemoteTemp && this->writes_.hasPending(lost.type);
+            if (superseded || lost.attempt >= WRITE_MAX_RETRANSMITS) {
+                ESP_LOGW(LOG_ACK, "%s not acknowledged within %u ms, giving up (%s)", WriteTracker::nameOf(lost.type),
+                    static_cast<unsigned int>(WRITE_ACK_TIMEOUT_MS), superseded ? "superseded" : "no retransmission left");
+                this->writes_.markLost(lost.type);
+                continue;
+            }
+            ESP_LOGW(LOG_ACK, "%s not acknowledged within %u ms, sending it again (%d/%d)", WriteTracker::nameOf(lost.type),
+                static_cast<unsigned int>(WRITE_ACK_TIMEOUT_MS), lost.attempt + 1, WRITE_MAX_RETRANSMITS);
+            this->writes_.markRetransmit(lost.type, lost.attempt + 1);
+            const uint32_t elapsed = CUSTOM_MILLIS - this->lastSend;
+            const uint32_t gap = this->pacing_.getSendGap();
+            this->enqueuePacket(lost.packet, lost.length, true, elapsed < gap ? gap - elapsed : 0);
+        }
     }
 
     void CN105Connection::processCommand(PacketCallback packetCallback) {
         switch (this->command) {
         case 0x61:  /* last update was successful */
-            hpPacketDebug(this->storedInputData, this->bytesRead + 1, LOG_ACK);
+            hpPacketDebug(this->storedInputData, this->dataLength + 6, LOG_ACK);
             this->updateSuccess();
             break;
 
@@ -320,7 +409,7 @@ namespace devicestate {
             ESP_LOGI(LOG_CONN_TAG, "--> Heatpump did reply: connection success (%s, 0x%02X)! <--",
                 (this->command == 0x7b) ? "Installer" : "User",
                 this->command);
-            hpPacketDebug(this->storedInputData, this->bytesRead + 1, LOG_CONN_TAG);
+            hpPacketDebug(this->storedInputData, this->dataLength + 6, LOG_CONN_TAG);
             
             this->setConnectionState(true);
             break;
@@ -334,68 +423,168 @@ namespace devicestate {
         connectedCallback_(state);
     }
 
-    void CN105Connection::processDataPacket(PacketCallback packetCallback) {
+    bool CN105Connection::processDataPacket(PacketCallback packetCallback) {
         ESP_LOGV(TAG, "processing data packet...");
 
         this->data = &storedInputData[5];
 
-        hpPacketDebug(this->storedInputData, this->bytesRead + 1, "READ");
+        // captured before the checksum test so corrupted frames can be inspected too
+        this->capture_.record(FrameDirection_RX, this->storedInputData, this->dataLength + 6, CUSTOM_MILLIS);
+        hpPacketDebug(this->storedInputData, this->dataLength + 6, "READ");
 
         // During handshake (while not connected), log all RX frames under CN105_CONN at DEBUG level
         // to facilitate diagnostics (0x7A/0x7B expected, or other unexpected response).
         if (!this->isHeatpumpConnected_) {
             ESP_LOGD(LOG_CONN_TAG, "RX during handshake (cmd=0x%02X len=%d)", this->command, this->dataLength);
-            hpPacketDebug(storedInputData, this->bytesRead + 1, LOG_CONN_TAG);
+            hpPacketDebug(storedInputData, this->dataLength + 6, LOG_CONN_TAG);
         }
 
-        if (this->checkSum()) {
-            // checkPoint of a heatpump response
-            this->lastResponseMs = CUSTOM_MILLIS;    //esphome::CUSTOM_MILLIS;
-
-            // processing the specific command
-            processCommand(packetCallback);
+        if (!this->checkSum()) {
+            return false;
         }
+
+        // checkPoint of a heatpump response
+        this->lastResponseMs = CUSTOM_MILLIS;    //esphome::CUSTOM_MILLIS;
+        // info round-trips are measured by the RequestScheduler, writes by the WriteTracker
+        this->pacing_.onResponse(this->command, this->data[0], this->lastResponseMs);
+
+        // processing the specific command
+        processCommand(packetCallback);
+        return true;
     }
 
-    void CN105Connection::parse(uint8_t inputData, PacketCallback packetCallback) {
-        ESP_LOGV("Decoder", "--> %02X [nb: %d]", inputData, this->bytesRead);
+    /**
+     * Removes count bytes from the head of storedInputData, keeping what follows
+    */
+    void CN105Connection::consumeBytes(int count) {
+        if (count >= this->bytesRead) {
+            this->bytesRead = 0;
+            return;
+        }
+        memmove(this->storedInputData, this->storedInputData + count, static_cast<size_t>(this->bytesRead - count));
+        this->bytesRead -= count;
+    }
 
-        bool hasNext = false;
-        if (!this->foundStart) {                // no packet yet
-            if (inputData == HEADER[0]) {
-                this->foundStart = true;
-                this->bytesRead = 0;
-                storedInputData[this->bytesRead++] = inputData;
-            } else {
-                // unknown bytes
+    /**
+     * Rejects the frame candidate at the head of the buffer (bad header, length or checksum):
+     * the start byte is discarded and the buffer is rescanned from the next 0xFC candidate,
+     * so a valid frame buried in the garbage is not lost.
+    */
+    void CN105Connection::resync(const char* reason) {
+        int dropped = this->bytesRead;
+        if (this->bytesRead > 1) {
+            const void* next = memchr(this->storedInputData + 1, HEADER[0], static_cast<size_t>(this->bytesRead - 1));
+            if (next != nullptr) {
+                dropped = static_cast<int>(static_cast<const uint8_t*>(next) - this->storedInputData);
             }
-        } else {                                // we are getting a packet
-            if (this->bytesRead >= (MAX_DATA_BYTES - 1)) {
-                ESP_LOGW("Decoder", "buffer overflow preventive reset (bytesRead=%d)", this->bytesRead);
-                this->initBytePointer();
+        }
+
+        this->resyncCount_++;
+        this->droppedBytes_ += dropped;
+        ESP_LOGW("Decoder", "%s error, resync dropping %d byte(s) (resyncs: %u, dropped bytes: %u)", reason, dropped,
+            static_cast<unsigned int>(this->resyncCount_), static_cast<unsigned int>(this->droppedBytes_));
+
+        this->consumeBytes(dropped);
+        this->decoderState = DecoderState::WAIT_START;
+        this->dataLength = -1;
+        this->command = 0;
+    }
+
+    /**
+     * Decoder state machine, runs over the bytes buffered in storedInputData.
+     * A frame is always decoded from the head of the buffer; whatever follows it
+     * stays buffered for the next iteration.
+    */
+    void CN105Connection::decode(PacketCallback packetCallback) {
+        while (this->bytesRead > 0) {
+            switch (this->decoderState) {
+            case DecoderState::WAIT_START: {
+                const void* start = memchr(this->storedInputData, HEADER[0], static_cast<size_t>(this->bytesRead));
+                const int offset = (start == nullptr) ? this->bytesRead :
+                    static_cast<int>(static_cast<const uint8_t*>(start) - this->storedInputData);
+                if (offset > 0) {               // unknown bytes
+                    this->droppedBytes_ += offset;
+                    this->consumeBytes(offset);
+                }
+                if (this->bytesRead > 0) {
+                    this->decoderState = DecoderState::HEADER;
+                }
+                break;
             }
-            storedInputData[this->bytesRead] = inputData;
 
-            checkHeader(inputData);
+            case DecoderState::HEADER:
+                if (this->bytesRead < FRAME_HEADER_LEN) {
+                    return;                     // header is not complete yet
+                }
+                if (this->checkHeader()) {
+                    this->decoderState = DecoderState::DATA;
+                } else {
+                    this->resync("header");
+                }
+                break;
 
-            if (this->dataLength != -1) {       // is header complete ?
-                if ((this->dataLength + 6) > MAX_DATA_BYTES) {
-                    ESP_LOGW("Decoder", "declared data length %d too large, resetting parser", this->dataLength);
-                    this->initBytePointer();
-                    return;
+            case DecoderState::DATA: {
+                const int frameLength = this->dataLength + 6;
+                if (this->bytesRead < frameLength) {
+                    return;                     // packet is still filling
+                }
+                if (this->processDataPacket(packetCallback)) {
+                    // the packet callback may have reset the decoder (reconnect), consumeBytes copes with it
+                    this->consumeBytes(frameLength);
+                    this->decoderState = DecoderState::WAIT_START;
+                    this->dataLength = -1;
+                    this->command = 0;
+                } else {
+                    this->resync("checksum");
                 }
+                break;
+            }
+            }
+        }
+    }
+
+    void CN105Connection::parse(uint8_t inputData, PacketCallback packetCallback) {
+        ESP_LOGV("Decoder", "--> %02X [nb: %d]", inputData, this->bytesRead);
+
+        if (this->bytesRead >= MAX_DATA_BYTES) {
+            this->resync("buffer overflow");
+        }
+        this->storedInputData[this->bytesRead++] = inputData;
+        this->decode(packetCallback);
+    }
 
-                if ((this->bytesRead) == this->dataLength + 5) {
-                    this->processDataPacket(packetCallback);
-                    this->initBytePointer();
-                } else {                                        // packet is still filling
-                    this->bytesRead++;                          // more data to come
+    /**
+     * Batch decoder: consumes a whole span of received bytes at once.
+     * Noise between frames is skipped with memchr before being buffered, and
+     * the bytes are copied in chunks instead of one parse() call per byte.
+    */
+    void CN105Connection::parseBuffer(const uint8_t* buffer, size_t length, PacketCallback packetCallback) {
+        size_t pos = 0;
+        while (pos < length) {
+            if (this->bytesRead == 0) {
+                const void* start = memchr(buffer + pos, HEADER[0], length - pos);
+                const size_t offset = (start == nullptr) ? (length - pos) :
+                    static_cast<size_t>(static_cast<const uint8_t*>(start) - (buffer + pos));
+                this->droppedBytes_ += offset;
+                pos += offset;
+                if (pos == length) {
+                    return;                     // no packet start in the remaining bytes
                 }
-            } else {
-                ESP_LOGV("Decoder", "data length toujours pas connu");
-                // header is not complete yet
-                this->bytesRead++;
             }
+
+            size_t chunk = static_cast<size_t>(MAX_DATA_BYTES - this->bytesRead);
+            if (chunk == 0) {
+                this->resync("buffer overflow");
+                continue;
+            }
+            if (chunk > length - pos) {
+                chunk = length - pos;
+            }
+            memcpy(&this->storedInputData[this->bytesRead], buffer + pos, chunk);
+            this->bytesRead += static_cast<int>(chunk);
+            pos += chunk;
+
+            this->decode(packetCallback);
         }
     }
 
@@ -407,13 +596,60 @@ namespace devicestate {
         return this->dataLength;
     }
 
+    uint32_t CN105Connection::getResyncCount() {
+        return this->resyncCount_;
+    }
+
+    uint32_t CN105Connection::getDroppedBytes() {
+        return this->droppedBytes_;
+    }
+
+    const WriteTracker& CN105Connection::getWriteTracker() {
+        return this->writes_;
+    }
+
+    bool CN105Connection::hasPendingWrite(WriteType type) {
+        return this->writes_.hasPending(type);
+    }
+
+    const FrameCapture& CN105Connection::getCapture() {
+        return this->capture_;
+    }
+
+    void CN105Connection::setPacingBounds(uint32_t floor_ms, uint32_t ceiling_ms) {
+        this->pacing_.set_bounds(floor_ms, ceiling_ms);
+    }
+
+    uint32_t CN105Connection::getWriteSettleDelay() {
+        return this->pacing_.getWriteSettleDelay();
+    }
+
+    bool CN105Connection::hasSendGapElapsed() {
+        return CUSTOM_MILLIS - this->lastSend > this->pacing_.getSendGap();
+    }
+
+    bool CN105Connection::isBusIdle() {
+        return this->tx_queue_.isEmpty() && !this->pacing_.isAwaitingResponse(CUSTOM_MILLIS);
+    }
+
     bool CN105Connection::processInput(PacketCallback packetCallback) {
+        this->expireWrites();
+
         bool processed = false;
-        while (this->io_device_->available()) {
+        uint8_t chunk[MAX_DATA_BYTES];
+        int available;
+        while ((available = this->io_device_->available()) > 0) {
             processed = true;
-            uint8_t inputData;
-            if (this->io_device_->read(&inputData)) {
-                parse(inputData, packetCallback);
+            size_t wanted = static_cast<size_t>(available) < sizeof(chunk) ? static_cast<size_t>(available) : sizeof(chunk);
+            size_t received = this->io_device_->read_array(chunk, wanted);
+            if (received > 0) {
+                this->parseBuffer(chunk, received, packetCallback);
+            } else {
+                // bulk read failed: fall back to the per-byte path
+                uint8_t inputData;
+                if (this->io_device_->read(&inputData)) {
+                    parse(inputData, packetCallback);
+                }
             }
         }
         return processed;
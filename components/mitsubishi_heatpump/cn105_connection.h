@@ -5,7 +5,12 @@
 #include "cn105_types.h"
 #include "cn105_state.h"
 
+#include "frame_capture.h"
+#include "frame_pacing.h"
 #include "io_device.h"
+#include "latency_histogram.h"
+#include "transmit_queue.h"
+#include "write_tracker.h"
 
 using namespace devicestate;
 
@@ -13,9 +18,11 @@ namespace devicestate {
 
     class CN105Connection {
         public:
-            using TimeoutCallback = std::function<void(const std::string&, uint32_t, std::function<void()>)>;
+            using TimeoutCallback = std::function<void(const char*, uint32_t, std::function<void()>)>;
             using ConnectedCallback = std::function<void(bool)>;
             using PacketCallback = std::function<void(const uint8_t* packet, const int dataLength)>;
+            // a frame went out on the UART, straight from writePacket() or later from the transmit queue
+            using SentCallback = std::function<void(const uint8_t* packet, int length)>;
 
             CN105Connection(
                 IIODevice* io_device,
@@ -29,26 +36,57 @@ namespace devicestate {
             bool ensureActiveConnection();
             void reconnectIfConnectionLost();
 
-            void writePacket(uint8_t* packet, int length, bool checkIsActive = true);
+            // true when the frame was transmitted, false when it was queued (or dropped, see isQueued())
+            bool writePacket(uint8_t* packet, int length, bool checkIsActive = true);
+            bool isQueued(uint8_t command, uint8_t code);
+            void set_sent_callback(SentCallback callback) { this->sentCallback_ = callback; }
 
             uint8_t* getData();
             int getDataLength();
             bool processInput(PacketCallback packetCallback);
 
+            uint32_t getResyncCount();
+            uint32_t getDroppedBytes();
+
+            // 0x41 writes waiting for their 0x61 ack, with per type ack round-trips and lost writes
+            const WriteTracker& getWriteTracker();
+            bool hasPendingWrite(WriteType type);
+
+            // last frames exchanged with the heatpump, both directions
+            const FrameCapture& getCapture();
+
+            void setPacingBounds(uint32_t floor_ms, uint32_t ceiling_ms);
+            // measured rest time after a settings write, 0 until the first write was acknowledged
+            uint32_t getWriteSettleDelay();
+            // nothing queued and no frame still waiting for its response
+            bool isBusIdle();
+            // the learned gap since the last frame sent is over
+            bool hasSendGapElapsed();
+
         private:
             IIODevice* io_device_;
             TimeoutCallback timeoutCallback_;
             ConnectedCallback connectedCallback_;
+            SentCallback sentCallback_;
             int update_interval_;
 
+            enum class DecoderState : uint8_t {
+                WAIT_START,     // looking for the 0xFC start byte
+                HEADER,         // waiting for the complete 5 bytes header
+                DATA            // waiting for the data bytes and the checksum
+            };
+
             uint8_t storedInputData[MAX_DATA_BYTES]; // multi-byte data
             uint8_t* data;
 
-            bool foundStart = false;
-            int bytesRead = 0;
+            DecoderState decoderState = DecoderState::WAIT_START;
+            int bytesRead = 0;                  // number of bytes buffered in storedInputData
             int dataLength = 0;
             uint8_t command = 0;
 
+            uint32_t resyncCount_ = 0;
+            uint32_t droppedBytes_ = 0;
+
             bool isHeatpumpConnected_ = false;
             bool isUARTConnected_ = false;
             bool firstRun = false;
@@ -60,10 +98,10 @@ namespace devicestate {
             bool conn_timeout_armed_ = false;
             uint32_t conn_bootstrap_delay_ms_{ 10000 };
 
-            uint8_t pending_packet_[PACKET_LEN] = {};
-            int pending_packet_len_ = 0;
-            bool pending_check_is_active_ = true;
-            bool has_pending_packet_ = false;
+            TransmitQueue tx_queue_;
+            FramePacing pacing_;
+            FrameCapture capture_;
+            WriteTracker writes_;
 
             unsigned long lastSend = 0;
             unsigned long lastConnectRqTimeMs = 0;
@@ -76,19 +114,27 @@ namespace devicestate {
 
             void initBytePointer();
             bool checkSum();
-            void checkHeader(uint8_t inputData);
+            bool checkHeader();
             void setupUART();
             void disconnectUART();
             void reconnectUART();
             //void force_low_level_uart_reinit();
             void sendFirstConnectionPacket();
 
+            bool canWrite(bool checkIsActive);
+            void transmit(const uint8_t* packet, int length);
+            void enqueuePacket(const uint8_t* packet, int length, bool checkIsActive, uint32_t flushDelay);
             void try_write_pending_packet();
 
             void updateSuccess();
+            void expireWrites();
             void processCommand(PacketCallback packetCallback);
-            void processDataPacket(PacketCallback packetCallback);
+            bool processDataPacket(PacketCallback packetCallback);
             void parse(uint8_t inputData, PacketCallback packetCallback);
+            void parseBuffer(const uint8_t* buffer, size_t length, PacketCallback packetCallback);
+            void decode(PacketCallback packetCallback);
+            void consumeBytes(int count);
+            void resync(const char* reason);
     };
 
 }
\ No newline at end of file
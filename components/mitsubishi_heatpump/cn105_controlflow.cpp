@@ -1,6 +1,8 @@
 #include "cn105_controlflow.h"
 
+#include "Globals.h"
 #include "cn105_logging.h"
+#include "logging.h"
 
 #include "esphome.h"
 
@@ -13,12 +15,10 @@ namespace devicestate {
             CN105State* hpState,
             RequestScheduler::TimeoutCallback timeoutCallback,
             RequestScheduler::TerminateCallback terminateCallback,
-            RetryCallback retryCallback,
             uint32_t debounce_delay,
             uint32_t remote_temp_timeout
         ): connection_{connection},
             timeoutCallback_{timeoutCallback},
-            retryCallback_{retryCallback},
             debounce_delay_{debounce_delay},
             remote_temp_timeout_{remote_temp_timeout},
             scheduler_(
@@ -32,6 +32,9 @@ namespace devicestate {
             ),
             hpProtocol{} {
         this->hpState_ = hpState;
+        this->connection_->set_sent_callback([this](const uint8_t* packet, int length) {
+            this->onPacketSent(packet, length);
+        });
     }
 
     void CN105ControlFlow::set_debounce_delay(uint32_t delay) {
@@ -39,57 +42,78 @@ namespace devicestate {
         log_info_uint32(LOG_ACTION_EVT_TAG, "set_debounce_delay is set to ", delay);
     }
 
-    void CN105ControlFlow::set_remote_temp_timeout(uint32_t timeout) {
-        this->remote_temp_timeout_ = timeout;
-        log_info_uint32(LOG_ACTION_EVT_TAG, "remote_temp_timeout is set to ", timeout);
+    void CN105ControlFlow::set_adaptive_polling(uint32_t min_interval, uint32_t max_interval) {
+        this->scheduler_.set_adaptive_polling(min_interval, max_interval);
     }
 
-#ifndef USE_ESP32
-    /**
-     * This methode emulates the esp32 lock_guard feature with a boolean variable
-     *
-    */
-    void CN105ControlFlow::emulateMutex(const char* retryName, std::function<void()>&& f) {
-        retryCallback_(retryName, 100, 10, [this, f, retryName](uint8_t retry_count) {
-            if (this->wantedSettingsMutex) {
-                if (retry_count < 1) {
-                    ESP_LOGW(retryName, "10 retry calls failed because mutex was locked, forcing unlock...");
-                    this->wantedSettingsMutex = false;  // Fixed: was incorrectly set to true
-                    f();
-                    this->wantedSettingsMutex = false;
-                    return esphome::RetryResult::DONE;
-                }
-                ESP_LOGI(retryName, "wantedSettingsMutex is already locked, defferring...");
-                return esphome::RetryResult::RETRY;
-            } else {
-                this->wantedSettingsMutex = true;
-                ESP_LOGD(retryName, "emulateMutex normal behaviour, locking...");
-                f();
-                ESP_LOGD(retryName, "emulateMutex unlocking...");
-                this->wantedSettingsMutex = false;
-                return esphome::RetryResult::DONE;
-            }
-            });
+    void CN105ControlFlow::set_remote_temp_fast_path(float delta, uint32_t min_interval) {
+        this->remoteTempFastDelta_ = delta;
+        this->remoteTempFastInterval_ = min_interval;
     }
-#endif
 
-    void CN105ControlFlow::sendWantedSettingsDelegate() {
-        this->hpState_->getWantedSettings().sent();
+    void CN105ControlFlow::set_remote_temp_dithering(uint32_t interval) {
+        this->remoteTempDitherInterval_ = interval;
+    }
 
-        wantedHeatpumpSettings wantedSettings = this->hpState_->getWantedSettings();
+    void CN105ControlFlow::set_remote_temp_timeout(uint32_t timeout) {
+        this->remote_temp_timeout_ = timeout;
+        log_info_uint32(LOG_ACTION_EVT_TAG, "remote_temp_timeout is set to ", timeout);
+    }
+
+    void CN105ControlFlow::sendWantedSettingsDelegate(wantedHeatpumpSettings& wantedSettings, uint32_t sequence) {
         debugSettings("wantedSettings", wantedSettings);
         // and then we send the update packet
 
         uint8_t packet[PACKET_LEN] = {};
-        hpProtocol.createPacket(packet, *this->hpState_);
-        this->connection_->writePacket(packet, PACKET_LEN);
+        hpProtocol.createPacket(packet, *this->hpState_, wantedSettings);
+
+        // the wanted settings are only consumed once the frame is on the wire, see onPacketSent()
+        memcpy(this->queuedSettingsPacket_, packet, PACKET_LEN);
+        this->queuedSettings_ = wantedSettings;
+        this->queuedSequence_ = sequence;
+        this->settingsQueued_ = true;
+        if (!this->connection_->writePacket(packet, PACKET_LEN)) {
+            ESP_LOGD(LOG_ACTION_EVT_TAG, "Settings write queued, wanted settings kept until it is sent");
+        }
         hpPacketDebug(packet, 22, "WRITE_SETTINGS");
+    }
+
+    void CN105ControlFlow::commitSettingsWrite() {
+        // read back as soon as the unit acknowledged it, see checkWriteConfirmation()
+        const uint32_t now = CUSTOM_MILLIS;
+        if (!this->confirmRetry_) {
+            this->confirmAttempts_ = 0;
+            this->confirmFirstWriteMs_ = now;
+        }
+        this->confirmRetry_ = false;
+        this->confirmSettings_ = this->queuedSettings_;
+        this->confirmState_ = WriteConfirm_AwaitAck;
+        this->confirmWriteMs_ = now;
+        this->confirmAcksBefore_ = this->connection_->getWriteTracker().getStats(WriteType_Settings).acked;
+
+        // the next cycle reads back what was written, whatever the adaptive intervals
+        this->scheduler_.expedite(0x02);
+        this->scheduler_.expedite(0x06);
+
+        this->hpState_->updateCurrentSettings(this->queuedSettings_);
 
-        this->hpState_->updateCurrentSettings(wantedSettings);
+        // as soon as the packet is sent, we reset the settings, unless they changed meanwhile
+        if (!this->hpState_->consumeWantedSettings(this->queuedSequence_)) {
+            ESP_LOGD(LOG_ACTION_EVT_TAG, "Wanted settings changed while being written, keeping them for the next write");
+        }
+    }
 
-        // as soon as the packet is sent, we reset the settings
-        //this->hpState_->getWantedSettings().resetSettings();
-        this->hpState_->resetWantedSettings();
+    void CN105ControlFlow::onPacketSent(const uint8_t* packet, int length) {
+        if (this->settingsQueued_ && length == PACKET_LEN && memcmp(packet, this->queuedSettingsPacket_, PACKET_LEN) == 0) {
+            this->settingsQueued_ = false;
+            this->commitSettingsWrite();
+        } else if (length > 5 && packet[1] == 0x42) {
+            // info requests and read-backs are timed from the actual transmission
+            this->scheduler_.mark_sent(packet[5]);
+            if (this->confirmState_ == WriteConfirm_AwaitRead && packet[5] == 0x02) {
+                this->confirmReadMs_ = CUSTOM_MILLIS;
+            }
+        }
     }
 
     bool CN105ControlFlow::sendWantedSettings() {
@@ -97,35 +121,120 @@ namespace devicestate {
             return false;
         }
 
-        auto callback = [this]() {
-            this->sendWantedSettingsDelegate();
-        };
-        this->acquireWantedSettingsLock(callback);
+        wantedHeatpumpSettings wantedSettings;
+        uint32_t sequence;
+        if (!this->hpState_->snapshotWantedSettings(wantedSettings, sequence)) {
+            // being written by the control path: the bus job stays pending for the next loop
+            ESP_LOGD(LOG_ACTION_EVT_TAG, "Wanted settings being updated, writing them on the next loop");
+            return false;
+        }
+        this->sendWantedSettingsDelegate(wantedSettings, sequence);
         return true;
     }
 
-    void CN105ControlFlow::checkPendingWantedSettings(cycleManagement& loopCycle) {
+    void CN105ControlFlow::sendConfirmRead() {
+        if (this->connection_->getWriteTracker().getStats(WriteType_Settings).acked == this->confirmAcksBefore_) {
+            ESP_LOGW(LOG_ACTION_EVT_TAG, "Settings write was not acknowledged, reading it back anyway");
+        }
+        ESP_LOGD(LOG_ACTION_EVT_TAG, "Reading back the settings write (attempt %d/%d)",
+            this->confirmAttempts_ + 1, WRITE_CONFIRM_MAX_ATTEMPTS);
+        this->confirmState_ = WriteConfirm_AwaitRead;
+        this->confirmReadMs_ = CUSTOM_MILLIS;
+        this->buildAndSendInfoPacket(0x02);
+    }
+
+    /**
+     * Compares the settings read back (already decoded into the current settings) with
+     * the fields of the last write; on mismatch the write is queued again, up to
+     * WRITE_CONFIRM_MAX_ATTEMPTS, unless a newer user demand is already waiting.
+    */
+    void CN105ControlFlow::checkWriteConfirmation() {
+        const wantedHeatpumpSettings& written = this->confirmSettings_;
+        const heatpumpSettings& current = this->hpState_->getCurrentSettings();
+        wantedHeatpumpSettings& wanted = this->hpState_->getWantedSettings();
+
+        if (wanted.hasChanged) {
+            // the next write carries a newer demand and will be read back itself
+            ESP_LOGD(LOG_ACTION_EVT_TAG, "Settings read-back superseded by a newer demand");
+            this->confirmState_ = WriteConfirm_Idle;
+            return;
+        }
+
+        const bool applied =
+            (written.power == PowerSetting_Unset || written.power == current.power) &&
+            (written.mode == ModeSetting_Unset || written.mode == current.mode) &&
+            (written.temperature == -1.0f || std::fabs(written.temperature - current.temperature) < 0.25f) &&
+            (written.fan == FanSetting_Unset || written.fan == current.fan) &&
+            (written.vane == VaneSetting_Unset || written.vane == current.vane) &&
+            (written.wideVane == WideVaneSetting_Unset || written.wideVane == current.wideVane);
+        if (applied) {
+            this->endWriteConfirmation(true);
+            return;
+        }
+
+        if (++this->confirmAttempts_ >= WRITE_CONFIRM_MAX_ATTEMPTS) {
+            this->endWriteConfirmation(false);
+            return;
+        }
+        ESP_LOGW(LOG_ACTION_EVT_TAG, "Settings write not applied yet, writing it again (attempt %d/%d)",
+            this->confirmAttempts_ + 1, WRITE_CONFIRM_MAX_ATTEMPTS);
+        this->hpState_->beginWantedSettingsUpdate();
+        wanted = written;
+        wanted.hasChanged = true;
+        wanted.hasBeenSent = false;
+        wanted.lastChange = CUSTOM_MILLIS - this->debounce_delay_;
+        this->hpState_->endWantedSettingsUpdate();
+        this->confirmRetry_ = true;
+        this->confirmState_ = WriteConfirm_Idle;
+    }
+
+    void CN105ControlFlow::endWriteConfirmation(bool applied) {
+        if (applied) {
+            ESP_LOGI(LOG_ACTION_EVT_TAG, "Settings write confirmed in %u ms",
+                static_cast<unsigned int>(CUSTOM_MILLIS - this->confirmFirstWriteMs_));
+        } else {
+            ESP_LOGW(LOG_ACTION_EVT_TAG, "Settings write still not applied after %d attempts", WRITE_CONFIRM_MAX_ATTEMPTS);
+        }
+        this->confirmState_ = WriteConfirm_Idle;
+        this->confirmAttempts_ = 0;
+        if (this->writeConfirmCallback_) {
+            this->writeConfirmCallback_(applied);
+        }
+    }
+
+    void CN105ControlFlow::restAfterWrite(cycleManagement& loopCycle) {
+        // as we've just sent a packet to the heatpump, we let it time for process
+        // this might not be necessary but, we give it a try because of issue #32
+        // https://github.com/echavet/MitsubishiCN105ESPHome/issues/32
+        if (loopCycle.isCycleRunning()) {
+            // the write pre-empted the cycle: its remaining polls wait for the same rest
+            this->pollReleaseMs_ = CUSTOM_MILLIS + this->connection_->getWriteSettleDelay();
+        } else {
+            loopCycle.deferCycle(this->connection_->getWriteSettleDelay());
+        }
+    }
+
+    bool CN105ControlFlow::checkPendingWantedSettings(cycleManagement& loopCycle) {
         long now = CUSTOM_MILLIS;
 
         if (!this->hpState_->getWantedSettings().hasChanged) {
             ESP_LOGI(LOG_ACTION_EVT_TAG, "Skipping checkPendingWantedSettings: %s", TRUEFALSE(this->hpState_->getWantedSettings().hasChanged));
-            return;
+            return false;
         }
 
         // Skip if not enough time has passed since last change (debounce)
         if ((now - this->hpState_->getWantedSettings().lastChange) < this->debounce_delay_) {
             ESP_LOGI(LOG_ACTION_EVT_TAG, "Skipping checkPendingWantedSettings: debounce delay not elapsed");
-            return;
+            return false;
         }
 
         ESP_LOGI(LOG_ACTION_EVT_TAG, "checkPendingWantedSettings - wanted settings have changed, sending them to the heatpump...");
 
-        if (this->sendWantedSettings()) {
-            // as we've just sent a packet to the heatpump, we let it time for process
-            // this might not be necessary but, we give it a try because of issue #32
-            // https://github.com/echavet/MitsubishiCN105ESPHome/issues/32
-            loopCycle.deferCycle();
+        if (!this->sendWantedSettings()) {
+            return false;
         }
+        this->restAfterWrite(loopCycle);
+        return true;
     }
 
     bool CN105ControlFlow::sendWantedRunStates() {
@@ -175,18 +284,17 @@ namespace devicestate {
         return false;
     }
 
-    void CN105ControlFlow::checkPendingWantedRunStates(cycleManagement& loopCycle) {
+    bool CN105ControlFlow::checkPendingWantedRunStates(cycleManagement& loopCycle) {
         long now = CUSTOM_MILLIS;
         if (!(this->hpState_->getWantedRunStates().hasChanged) || (now - this->hpState_->getWantedRunStates().lastChange < this->debounce_delay_)) {
-            return;
+            return false;
         }
         ESP_LOGI(LOG_ACTION_EVT_TAG, "checkPendingWantedRunStates - wanted run states have changed, sending them to the heatpump...");
-        if (this->sendWantedRunStates()) {
-            // as we've just sent a packet to the heatpump, we let it time for process
-            // this might not be necessary but, we give it a try because of issue #32
-            // https://github.com/echavet/MitsubishiCN105ESPHome/issues/32
-            loopCycle.deferCycle();
+        if (!this->sendWantedRunStates()) {
+            return false;
         }
+        this->restAfterWrite(loopCycle);
+        return true;
     }
 
     void CN105ControlFlow::buildAndSendRequestPacket(int packetType) {
@@ -206,10 +314,15 @@ namespace devicestate {
         this->buildAndSendInfoPacket(code);
     }
 
-    void CN105ControlFlow::buildAndSendInfoPacket(uint8_t code) {
+    bool CN105ControlFlow::buildAndSendInfoPacket(uint8_t code) {
         uint8_t packet[PACKET_LEN] = {};
         hpProtocol.createInfoPacket(packet, code);
-        this->connection_->writePacket(packet, PACKET_LEN);
+        if (!this->connection_->writePacket(packet, PACKET_LEN)) {
+            // sent from the transmit queue later, the request timeout covers a dropped one
+            ESP_LOGD(TAG, "Info request 0x%02X queued", code);
+            return false;
+        }
+        return true;
     }
 
     void CN105ControlFlow::buildAndSendRequestsInfoPackets(cycleManagement& loopCycle) {
@@ -232,10 +345,26 @@ namespace devicestate {
         // While the connection has not succeeded, we don't start ANY cycle/write (otherwise it short-circuits the delay).
         // We still continue to read/process input to detect 0x7A/0x7B (connection success).
         const bool can_talk_to_hp = this->connection_->isConnected();
+        if (can_talk_to_hp && !this->wasConnected_) {
+            // settings were reset on (re)connection: poll everything again
+            this->scheduler_.expedite_all();
+        }
+        this->wasConnected_ = can_talk_to_hp;
         if (!this->connection_->processInput(
-                [this](const uint8_t* packet, const int dataLength) {
+                [this, &loopCycle](const uint8_t* packet, const int dataLength) {
                     const uint8_t code = packet[0];
-                    if (this->scheduler_.process_response(code)) {
+                    if (this->scheduler_.receive_response(code, packet, static_cast<size_t>(dataLength))) {
+                        if (code == 0x02 && this->confirmState_ == WriteConfirm_AwaitRead) {
+                            // read-back of a write, out of the polling cycle
+                            this->checkWriteConfirmation();
+                            this->dispatchBusJobs(loopCycle);
+                            return;
+                        }
+                        // the cycle goes on through the bus scheduler, so a due write can take the bus first
+                        this->lastPolledCode_ = code;
+                        this->pollReleaseMs_ = CUSTOM_MILLIS;
+                        this->pollContinuationPending_ = true;
+                        this->dispatchBusJobs(loopCycle);
                         return;
                     }
                     ESP_LOGW(TAG, "Scheduler failed to process response.");
@@ -246,22 +375,142 @@ namespace devicestate {
                 return;
             }
 
-            if (this->hpState_->getWantedSettings().hasChanged && (!loopCycle.isCycleRunning())) {
-                //ESP_LOGI(TAG, "Settings changed, updating: %s", TRUEFALSE(this->hpState_->getWantedSettings().hasChanged));
-                this->checkPendingWantedSettings(loopCycle);
-            } else if (this->hpState_->getWantedRunStates().hasChanged && (!loopCycle.isCycleRunning())) {
-                ESP_LOGD(TAG, "Run states changed, updating: %s", TRUEFALSE(this->hpState_->getWantedRunStates().hasChanged));
-                this->checkPendingWantedRunStates(loopCycle);
+            this->dispatchBusJobs(loopCycle);
+        }
+    }
+
+    void CN105ControlFlow::postBusJobs(cycleManagement& loopCycle) {
+        if (this->settingsQueued_ && !this->connection_->isQueued(0x41, 0x01)) {
+            // dropped or evicted before reaching the unit: the wanted settings were kept, write them again
+            ESP_LOGW(LOG_ACTION_EVT_TAG, "Settings write never sent, writing it again");
+            this->settingsQueued_ = false;
+        }
+        // control writes are due as soon as their debounce delay is over, and held while the previous
+        // write of the same kind waits for its ack: a retransmission must never land after a newer write
+        const wantedHeatpumpSettings& wantedSettings = this->hpState_->getWantedSettings();
+        if (wantedSettings.hasChanged && !this->settingsQueued_ && !this->connection_->hasPendingWrite(WriteType_Settings)) {
+            const uint32_t release = static_cast<uint32_t>(wantedSettings.lastChange) + this->debounce_delay_;
+            this->bus_.post(BusJob_Settings, release, release);
+        } else {
+            this->bus_.cancel(BusJob_Settings);
+        }
+
+        const wantedHeatpumpRunStates& wantedRunStates = this->hpState_->getWantedRunStates();
+        if (wantedRunStates.hasChanged && !this->connection_->hasPendingWrite(WriteType_RunStates)) {
+            const uint32_t release = static_cast<uint32_t>(wantedRunStates.lastChange) + this->debounce_delay_;
+            this->bus_.post(BusJob_RunStates, release, release);
+        } else {
+            this->bus_.cancel(BusJob_RunStates);
+        }
+
+        if (this->remoteTemperatureRaw_ > 0 && CUSTOM_MILLIS - this->lastDitherStepMs_ >= this->remoteTempDitherInterval_) {
+            this->ditherRemoteTemperature();
+        }
+
+        // the remote temperature has to reach the unit within one polling period, like when it was sent at the end of each cycle;
+        // a large change is due at once, in the next gap between two info requests, unless the last one was too recent
+        if (this->shouldSendExternalTemperature_ && this->remoteTempUrgent_) {
+            uint32_t release = this->remoteTempRequestMs_;
+            if (this->remoteTempFastSent_) {
+                const uint32_t allowed = this->lastRemoteTempFastMs_ + this->remoteTempFastInterval_;
+                if (static_cast<int32_t>(allowed - release) > 0) {
+                    release = allowed;
+                }
+            }
+            this->bus_.post(BusJob_RemoteTemp, release, release);
+        } else if (this->shouldSendExternalTemperature_) {
+            this->bus_.post(BusJob_RemoteTemp, this->remoteTempRequestMs_, this->remoteTempRequestMs_ + loopCycle.update_interval);
+        } else {
+            this->bus_.cancel(BusJob_RemoteTemp);
+        }
+
+        // the read-back of a write goes right after its ack (the bus is busy until then)
+        if (this->confirmState_ == WriteConfirm_AwaitRead && CUSTOM_MILLIS - this->confirmReadMs_ > WRITE_CONFIRM_READ_TIMEOUT_MS) {
+            ESP_LOGW(LOG_ACTION_EVT_TAG, "No answer to the settings read-back");
+            if (++this->confirmAttempts_ < WRITE_CONFIRM_MAX_ATTEMPTS) {
+                this->confirmState_ = WriteConfirm_AwaitAck;
+            } else {
+                this->endWriteConfirmation(false);
+            }
+        }
+        if (this->confirmState_ == WriteConfirm_AwaitAck && !this->connection_->hasPendingWrite(WriteType_Settings)) {
+            this->bus_.post(BusJob_ConfirmRead, this->confirmWriteMs_, this->confirmWriteMs_);
+        } else {
+            this->bus_.cancel(BusJob_ConfirmRead);
+        }
+
+        // a running cycle should be over one update interval after it started
+        if (loopCycle.isCycleRunning()) {
+            if (this->pollContinuationPending_) {
+                this->bus_.post(BusJob_InfoPoll, this->pollReleaseMs_,
+                    static_cast<uint32_t>(loopCycle.lastCycleStartMs) + loopCycle.update_interval);
+            } else {
+                // the request in flight has not been answered yet
+                this->bus_.cancel(BusJob_InfoPoll);
+            }
+        } else {
+            this->pollContinuationPending_ = false;
+            const uint32_t release = static_cast<uint32_t>(loopCycle.lastCompleteCycleMs) + loopCycle.update_interval + 1;
+            this->bus_.post(BusJob_InfoPoll, release, release + loopCycle.update_interval);
+        }
+    }
+
+    bool CN105ControlFlow::runBusJob(BusJob job, cycleManagement& loopCycle) {
+        switch (job) {
+        case BusJob_Settings:
+            return this->checkPendingWantedSettings(loopCycle);
+        case BusJob_RunStates:
+            return this->checkPendingWantedRunStates(loopCycle);
+        case BusJob_RemoteTemp:
+            ESP_LOGI(LOG_REMOTE_TEMP, "Sending remote temperature...");
+            this->sendRemoteTemperature();
+            return true;
+        case BusJob_ConfirmRead:
+            this->sendConfirmRead();
+            return true;
+        case BusJob_InfoPoll:
+            if (loopCycle.isCycleRunning()) {
+                this->pollContinuationPending_ = false;
+                this->scheduler_.send_next_after(this->lastPolledCode_);
             } else {
-                if (loopCycle.isCycleRunning()) {                         // if we are  running an update cycle
-                    loopCycle.checkTimeout();
-                } else { // we are not running a cycle
-                    if (loopCycle.hasUpdateIntervalPassed()) {
-                        this->buildAndSendRequestsInfoPackets(loopCycle);            // initiate an update cycle with this->cycleStarted();
+                this->buildAndSendRequestsInfoPackets(loopCycle);
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Gives the bus to the released transaction with the earliest deadline, once the
+     * previous frame got its answer. Writes also wait for the frame gap, the polls
+     * behind them wait with them; a write that has nothing to send steps aside.
+    */
+    void CN105ControlFlow::dispatchBusJobs(cycleManagement& loopCycle) {
+        this->postBusJobs(loopCycle);
+
+        if (this->connection_->isBusIdle()) {
+            const uint32_t now = CUSTOM_MILLIS;
+            for (BusJob job = this->bus_.next(now); job != BusJob_None; job = this->bus_.next(now)) {
+                if (BusScheduler::priorityOf(job) != TxPriority_Info) {
+                    if (!this->connection_->hasSendGapElapsed()) {
+                        // writes keep the frame gap: hold the bus for this one rather than sending a poll
+                        break;
                     }
+                    if (this->pollContinuationPending_ && loopCycle.isCycleRunning()) {
+                        ESP_LOGD(LOG_CYCLE_TAG, "%s pre-empts the polling cycle", BusScheduler::nameOf(job));
+                    }
+                }
+                if (this->runBusJob(job, loopCycle)) {
+                    return;
                 }
+                this->bus_.cancel(job);
             }
         }
+
+        if (loopCycle.isCycleRunning()) {
+            loopCycle.checkTimeout();
+        }
     }
 
     void CN105ControlFlow::registerInfoRequests() {
@@ -269,22 +518,28 @@ namespace devicestate {
 
         // 0x02 Settings
         InfoRequest r_settings("settings", "Settings", 0x02, 3, 0);
-        r_settings.onResponse = [this](CN105State& self) {
-            this->hpProtocol.parseSettings0x02(this->connection_->getData(), self);
+        r_settings.owner = this;
+        r_settings.onResponse = [](void* owner, CN105State& self) {
+            auto* flow = static_cast<CN105ControlFlow*>(owner);
+            flow->hpProtocol.parseSettings0x02(flow->connection_->getData(), self);
         };
         scheduler_.register_request(r_settings);
 
         // 0x03 Room temperature
         InfoRequest r_room("room_temp", "Room temperature", 0x03, 3, 0);
-        r_room.onResponse = [this](CN105State& self) {
-            this->hpProtocol.parseStatus0x03(this->connection_->getData(), self);
-         };
+        r_room.owner = this;
+        r_room.onResponse = [](void* owner, CN105State& self) {
+            auto* flow = static_cast<CN105ControlFlow*>(owner);
+            flow->hpProtocol.parseStatus0x03(flow->connection_->getData(), self);
+        };
         scheduler_.register_request(r_room);
 
         // 0x06 Status
         InfoRequest r_status("status", "Status", 0x06, 3, 0);
-        r_status.onResponse = [this](CN105State& self) {
-            this->hpProtocol.parseStatus0x06(this->connection_->getData(), self);
+        r_status.owner = this;
+        r_status.onResponse = [](void* owner, CN105State& self) {
+            auto* flow = static_cast<CN105ControlFlow*>(owner);
+            flow->hpProtocol.parseStatus0x06(flow->connection_->getData(), self);
         };
         scheduler_.register_request(r_status);
 
@@ -297,13 +552,15 @@ namespace devicestate {
 
         // 0x42 HVAC options
         InfoRequest r_hvac_opts("hvac_options", "HVAC options", 0x42, 3, 500);
-        r_hvac_opts.canSend = [this](const CN105State& self) {
-            (void)self;
+        r_hvac_opts.owner = this;
+        r_hvac_opts.canSend = [](void* owner, const CN105State& self) {
+            (void)owner; (void)self;
             //return (this->air_purifier_switch_ != nullptr || this->night_mode_switch_ != nullptr || this->circulator_switch_ != nullptr);
             return false;
         };
-        r_hvac_opts.onResponse = [this](CN105State& self) {
-            //(void)self; this->getHVACOptionsFromResponsePacket();
+        r_hvac_opts.onResponse = [](void* owner, CN105State& self) {
+            (void)owner; (void)self;
+            //this->getHVACOptionsFromResponsePacket();
             ESP_LOGW(TAG, "hvac_options");
         };
         r_hvac_opts.disabled = true;
@@ -323,14 +580,7 @@ namespace devicestate {
     }
 
     bool CN105ControlFlow::getOffsetDirection() {
-        if (this->hpState_->getCurrentSettings().mode == nullptr) {
-            return false;
-        }
-
-        if (std::strcmp(this->hpState_->getCurrentSettings().mode, "HEAT") == 0) {
-            return true;
-        }
-        return false;
+        return this->hpState_->getCurrentSettings().mode == ModeSetting_Heat;
     }
 
     void CN105ControlFlow::setRemoteTemperature(const float current) {
@@ -339,27 +589,69 @@ namespace devicestate {
             return;
         }
 
+        if (this->remoteTempDitherInterval_ > 0 && current > 0) {
+            // dithered: the sent half degrees step around the reading, see ditherRemoteTemperature()
+            const bool started = this->remoteTemperatureRaw_ > 0;
+            this->remoteTemperatureRaw_ = current;
+            // only readings keep the remote temperature alive, not the dithering steps
+            this->pingExternalTemperature();
+            if (!started || (this->remoteTempFastDelta_ > 0 &&
+                    std::fabs(current - this->lastSentRemoteTemperature_) >= this->remoteTempFastDelta_)) {
+                this->remoteTempDitherError_ = 0;
+                this->ditherRemoteTemperature();
+            }
+            return;
+        }
+        this->remoteTemperatureRaw_ = 0;
+        this->remoteTempDitherError_ = 0;
+
         const float normalizedRemoteTemp = this->getOffsetDirection()
             ? std::ceil(current * 2.0) / 2.0
             : std::floor(current * 2.0) / 2.0;
-        
-        this->remoteTemperature_ = normalizedRemoteTemp;
-        this->shouldSendExternalTemperature_ = true;
-        ESP_LOGD(LOG_REMOTE_TEMP, "setting remote temperature to %f", this->remoteTemperature_);
+        this->queueRemoteTemperature(normalizedRemoteTemp);
     }
 
-    void CN105ControlFlow::completeCycle() {
-        if (this->shouldSendExternalTemperature_) {
-            // We will receive ACK packet for this.
-            // Sending WantedSettings must be delayed in this case (lastSend timestamp updated).        
-            ESP_LOGI(LOG_REMOTE_TEMP, "Sending remote temperature...");
-            this->sendRemoteTemperature();
-            ESP_LOGI(LOG_REMOTE_TEMP, "Sent remote temperature...");
+    /**
+     * One step of a first order sigma-delta modulator: the difference between the
+     * reading and the half degree sent is carried over to the next step, so the
+     * values seen by the unit average to the reading over time.
+    */
+    void CN105ControlFlow::ditherRemoteTemperature() {
+        this->lastDitherStepMs_ = CUSTOM_MILLIS;
+        const float target = this->remoteTemperatureRaw_ + this->remoteTempDitherError_;
+        const float step = std::round(target * 2.0f) / 2.0f;
+        this->remoteTempDitherError_ = target - step;
+        if (step != this->remoteTemperature_) {
+            this->queueRemoteTemperature(step);
         }
     }
 
+    void CN105ControlFlow::queueRemoteTemperature(const float normalizedRemoteTemp) {
+        this->remoteTemperature_ = normalizedRemoteTemp;
+        if (!this->shouldSendExternalTemperature_) {
+            this->remoteTempRequestMs_ = CUSTOM_MILLIS;
+        }
+        this->shouldSendExternalTemperature_ = true;
+        if (this->remoteTempFastDelta_ > 0 &&
+                std::fabs(normalizedRemoteTemp - this->lastSentRemoteTemperature_) >= this->remoteTempFastDelta_) {
+            if (!this->remoteTempUrgent_) {
+                ESP_LOGD(LOG_REMOTE_TEMP, "remote temperature moved by %.1f since last sent, sending it without waiting for the cycle",
+                    std::fabs(normalizedRemoteTemp - this->lastSentRemoteTemperature_));
+                this->remoteTempRequestMs_ = CUSTOM_MILLIS;
+            }
+            this->remoteTempUrgent_ = true;
+        }
+        ESP_LOGD(LOG_REMOTE_TEMP, "setting remote temperature to %f", this->remoteTemperature_);
+    }
+
     void CN105ControlFlow::sendRemoteTemperature() {
         this->shouldSendExternalTemperature_ = false;
+        if (this->remoteTempUrgent_) {
+            this->remoteTempUrgent_ = false;
+            this->remoteTempFastSent_ = true;
+            this->lastRemoteTempFastMs_ = CUSTOM_MILLIS;
+        }
+        this->lastSentRemoteTemperature_ = this->remoteTemperature_;
 
         uint8_t packet[PACKET_LEN] = {};
         hpProtocol.prepareSetPacket(packet, PACKET_LEN);
@@ -378,9 +670,12 @@ namespace devicestate {
         packet[21] = chkSum;
         ESP_LOGD(LOG_REMOTE_TEMP, "Sending remote temperature packet... -> %f", this->remoteTemperature_);
         this->connection_->writePacket(packet, PACKET_LEN);
+        this->scheduler_.expedite(0x03);
 
         // this resets the timeout
-        this->pingExternalTemperature();
+        if (this->remoteTemperatureRaw_ <= 0) {
+            this->pingExternalTemperature();
+        }
     }
 
     void CN105ControlFlow::pingExternalTemperature() {
@@ -390,13 +685,39 @@ namespace devicestate {
         });
     }
 
-    void CN105ControlFlow::acquireWantedSettingsLock(AcquireCallback callback) {
-#ifdef USE_ESP32
-        std::lock_guard<std::mutex> guard(wantedSettingsMutex);
+    void CN105ControlFlow::updateWantedSettings(const UpdateCallback& callback) {
+        // one write section around the whole demand, so the bus path never sends half of it
+        this->hpState_->beginWantedSettingsUpdate();
         callback();
-#else
-        this->emulateMutex("WRITE_SETTINGS", std::move(callback));
-#endif
+        this->hpState_->endWantedSettingsUpdate();
+    }
+
+    void CN105ControlFlow::logLatency() {
+        ESP_LOGI(LOG_LATENCY_TAG, "round-trip histograms, bucket edges (ms): 20 40 60 80 100 150 200 300 500 750 1000 2000 +");
+        this->scheduler_.log_latency(LOG_LATENCY_TAG);
+        const WriteTracker& writes = this->connection_->getWriteTracker();
+        for (uint8_t i = 0; i < WriteType_Count; i++) {
+            const WriteStats& stats = writes.getStats(static_cast<WriteType>(i));
+            if (stats.sent == 0) {
+                continue;
+            }
+            stats.ackLatency.log(LOG_LATENCY_TAG, WriteTracker::nameOf(static_cast<WriteType>(i)));
+            ESP_LOGI(LOG_LATENCY_TAG, "%s: %u sent, %u acked, %u retransmitted, %u lost", WriteTracker::nameOf(static_cast<WriteType>(i)),
+                static_cast<unsigned int>(stats.sent), static_cast<unsigned int>(stats.acked),
+                static_cast<unsigned int>(stats.retransmitted), static_cast<unsigned int>(stats.lost));
+        }
+    }
+
+    void CN105ControlFlow::logFrames() {
+        this->connection_->getCapture().log(LOG_CAPTURE_TAG);
+    }
+
+    void CN105ControlFlow::mergeLatency(LatencyHistogram& into) {
+        this->scheduler_.merge_latency(into);
+        const WriteTracker& writes = this->connection_->getWriteTracker();
+        for (uint8_t i = 0; i < WriteType_Count; i++) {
+            into.merge(writes.getStats(static_cast<WriteType>(i)).ackLatency);
+        }
     }
 
 }
@@ -1,9 +1,5 @@
 #pragma once
 
-#ifdef USE_ESP32
-#include <mutex>
-#endif
-
 #include "io_device.h"
 
 #include "cn105_types.h"
@@ -14,6 +10,7 @@
 
 #include "cycle_management.h"
 #include "request_scheduler.h"
+#include "bus_scheduler.h"
 
 #include "esphome.h"
 
@@ -21,66 +18,124 @@ namespace devicestate {
 
     class CN105ControlFlow {
         public:
-            using RetryCallback = std::function<void(const std::string&, uint32_t, uint8_t, std::function<esphome::RetryResult(uint8_t)>)>;
-            using AcquireCallback = std::function<void()>;
+            using UpdateCallback = std::function<void()>;
+            // a settings write was read back: applied (true) or still not after the last attempt (false)
+            using WriteConfirmCallback = std::function<void(bool)>;
 
             CN105ControlFlow(
                 CN105Connection* connection,
                 CN105State* hpState,
                 RequestScheduler::TimeoutCallback timeoutCallback,
                 RequestScheduler::TerminateCallback terminateCallback,
-                RetryCallback retryCallback,
                 uint32_t debounce_delay = 0,
                 uint32_t remote_temp_timeout = 4294967295
             );
 
             void set_debounce_delay(uint32_t delay);
             void set_remote_temp_timeout(uint32_t timeout);
+            // remote temperature changes of at least delta (°C) are sent right away, at most once per min_interval ms
+            void set_remote_temp_fast_path(float delta, uint32_t min_interval);
+            // sends the remote temperature alternating between the two closest half degrees, one step every interval ms (0: off)
+            void set_remote_temp_dithering(uint32_t interval);
+            void set_write_confirm_callback(WriteConfirmCallback callback) { this->writeConfirmCallback_ = callback; }
+            // per-code poll intervals within [min_interval, max_interval] ms, max_interval 0 polls every code each cycle
+            void set_adaptive_polling(uint32_t min_interval, uint32_t max_interval);
 
             void loop(cycleManagement& loopCycle);
             void registerInfoRequests();
 
             void setRemoteTemperature(const float current);
             void pingExternalTemperature();
-            void completeCycle();
 
-            void acquireWantedSettingsLock(AcquireCallback callback);
+            // runs callback as one update of the wanted settings, right away
+            void updateWantedSettings(const UpdateCallback& callback);
+
+            // round-trip statistics of info requests and writes
+            void logLatency();
+            void mergeLatency(LatencyHistogram& into);
+            void logFrames();
 
         private:
             CN105Connection* connection_;
             CN105State* hpState_;
             RequestScheduler::TimeoutCallback timeoutCallback_;
-            RetryCallback retryCallback_;
             uint32_t debounce_delay_;
             uint32_t remote_temp_timeout_;
             RequestScheduler scheduler_;
+            BusScheduler bus_;
             CN105Protocol hpProtocol;
 
+            bool wasConnected_ = false;
             bool shouldSendExternalTemperature_ = false;
+            uint32_t remoteTempRequestMs_ = 0;
+            // fast path: a large enough change skips the batching with the polling cycle
+            float remoteTempFastDelta_ = REMOTE_TEMP_FAST_DELTA_DEFAULT;
+            uint32_t remoteTempFastInterval_ = REMOTE_TEMP_FAST_INTERVAL_DEFAULT_MS;
+            bool remoteTempUrgent_ = false;
+            bool remoteTempFastSent_ = false;
+            uint32_t lastRemoteTempFastMs_ = 0;
+            float lastSentRemoteTemperature_ = 0;
+            // dithering: reading (0 when off or on the internal sensor) and error carried to the next step
+            uint32_t remoteTempDitherInterval_ = 0;
+            float remoteTemperatureRaw_ = 0;
+            float remoteTempDitherError_ = 0;
+            uint32_t lastDitherStepMs_ = 0;
+
+            // the polling cycle resumes after lastPolledCode_ once released
+            bool pollContinuationPending_ = false;
+            uint8_t lastPolledCode_ = 0x00;
+            uint32_t pollReleaseMs_ = 0;
+
+            // read-after-write confirmation of the last settings write
+            enum WriteConfirmState : uint8_t {
+                WriteConfirm_Idle,
+                WriteConfirm_AwaitAck,      // written, read-back released once the 0x61 ack is in
+                WriteConfirm_AwaitRead      // 0x02 read-back sent
+            };
+            WriteConfirmState confirmState_ = WriteConfirm_Idle;
+            wantedHeatpumpSettings confirmSettings_{};
+            uint8_t confirmAttempts_ = 0;
+            bool confirmRetry_ = false;
+            uint32_t confirmFirstWriteMs_ = 0;
+            uint32_t confirmWriteMs_ = 0;
+            uint32_t confirmReadMs_ = 0;
+            uint32_t confirmAcksBefore_ = 0;
+            WriteConfirmCallback writeConfirmCallback_;
+            // settings write handed to the connection, committed once its frame is transmitted
+            bool settingsQueued_ = false;
+            uint8_t queuedSettingsPacket_[PACKET_LEN] = {};
+            wantedHeatpumpSettings queuedSettings_{};
+            uint32_t queuedSequence_ = 0;
             float remoteTemperature_ = 0;
 
-#ifdef USE_ESP32
-            std::mutex wantedSettingsMutex;
-#else
-            void emulateMutex(const char* retryName, std::function<void()>&& f);
-            volatile bool wantedSettingsMutex = false;
-#endif
-
             bool processInput(CN105State& hpState);
-            void buildAndSendInfoPacket(uint8_t code);
+            bool buildAndSendInfoPacket(uint8_t code);
+            void onPacketSent(const uint8_t* packet, int length);
             void buildAndSendRequestsInfoPackets(cycleManagement& loopCycle);
             void buildAndSendRequestPacket(int packetType);
 
-            void sendWantedSettingsDelegate();
+            void postBusJobs(cycleManagement& loopCycle);
+            bool runBusJob(BusJob job, cycleManagement& loopCycle);
+            void dispatchBusJobs(cycleManagement& loopCycle);
+            void restAfterWrite(cycleManagement& loopCycle);
+
+            void sendConfirmRead();
+            void checkWriteConfirmation();
+            void endWriteConfirmation(bool applied);
+
+            void sendWantedSettingsDelegate(wantedHeatpumpSettings& wantedSettings, uint32_t sequence);
+            void commitSettingsWrite();
             bool sendWantedSettings();
-            void checkPendingWantedSettings(cycleManagement& loopCycle);
+            bool checkPendingWantedSettings(cycleManagement& loopCycle);
 
             bool sendWantedRunStates();
-            void checkPendingWantedRunStates(cycleManagement& loopCycle);
+            bool checkPendingWantedRunStates(cycleManagement& loopCycle);
 
             bool getOffsetDirection();
 
             void sendRemoteTemperature();
+            void queueRemoteTemperature(const float normalizedRemoteTemp);
+            void ditherRemoteTemperature();
     };
 
 }
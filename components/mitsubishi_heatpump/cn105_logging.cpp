@@ -7,37 +7,39 @@
 
 namespace devicestate {
 
-    void hpPacketDebug(uint8_t* packet, unsigned int length, const char* packetDirection) {
-        // Build the output string safely and efficiently
-        std::string output;
-        output.reserve(length * 3 + 1); // "FF " per byte
-
-        char byteBuf[4];
+    void hpPacketDebug(const uint8_t* packet, unsigned int length, const char* packetDirection) {
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+        // called for every frame: formatted on the stack, "FF " per byte
+        char output[MAX_DATA_BYTES * 3 + 1];
+        if (length > MAX_DATA_BYTES) {
+            length = MAX_DATA_BYTES;
+        }
+        static const char HEX_DIGITS[] = "0123456789ABCDEF";
+        unsigned int pos = 0;
         for (unsigned int i = 0; i < length; i++) {
-            // Always bounded to 3 characters + NUL
-            int written = snprintf(byteBuf, sizeof(byteBuf), "%02X ", packet[i]);
-            if (written > 0) {
-                output.append(byteBuf, static_cast<size_t>(written));
-            }
+            output[pos++] = HEX_DIGITS[packet[i] >> 4];
+            output[pos++] = HEX_DIGITS[packet[i] & 0x0F];
+            output[pos++] = ' ';
         }
-
-        char outputForSensor[15];
-        // Properly truncate for eventual publication to a sensor
-        strncpy(outputForSensor, output.c_str(), sizeof(outputForSensor) - 1);
-        outputForSensor[sizeof(outputForSensor) - 1] = '\0';
-
-        ESP_LOGD(packetDirection, "%s", output.c_str());
+        output[pos] = '\0';
+
+        ESP_LOGD(packetDirection, "%s", output);
+#else
+        (void)packet;
+        (void)length;
+        (void)packetDirection;
+#endif
     }
 
     void debugSettings(const char* settingName, heatpumpSettings& settings) {
         ESP_LOGI(LOG_SETTINGS_TAG, "[%s]-> [power: %s, target °C: %.1f, mode: %s, fan: %s, vane: %s, wvane: %s]",
             getIfNotNull(settingName, "unnamed"),
-            getIfNotNull(settings.power, "-"),
+            getIfNotNull(powerSettingToString(settings.power), "-"),
             settings.temperature,
-            getIfNotNull(settings.mode, "-"),
-            getIfNotNull(settings.fan, "-"),
-            getIfNotNull(settings.vane, "-"),
-            getIfNotNull(settings.wideVane, "-")
+            getIfNotNull(modeSettingToString(settings.mode), "-"),
+            getIfNotNull(fanSettingToString(settings.fan), "-"),
+            getIfNotNull(vaneSettingToString(settings.vane), "-"),
+            getIfNotNull(wideVaneSettingToString(settings.wideVane), "-")
         );
     }
 
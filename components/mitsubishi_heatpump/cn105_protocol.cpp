@@ -49,54 +49,57 @@ namespace devicestate {
         }  
     }
 
-    void CN105Protocol::createPacket(uint8_t* packet, CN105State& hpState) {
+    void CN105Protocol::createPacket(uint8_t* packet, CN105State& hpState, const wantedHeatpumpSettings& wantedSettings) {
         prepareSetPacket(packet, PACKET_LEN);
 
         //ESP_LOGD(TAG, "checking differences bw asked settings and current ones...");
         ESP_LOGD(TAG, "building packet for writing...");
 
-        wantedHeatpumpSettings wantedSettings = hpState.getWantedSettings();
-        if (wantedSettings.power != nullptr) {
-            ESP_LOGD(TAG, "power -> %s", SAFE_STR(hpState.getPowerSetting()));
-            int idx = lookupByteMapIndex(POWER_MAP, 2, hpState.getPowerSetting(), "power (write)");
-            if (idx >= 0) { packet[8] = POWER[idx]; packet[6] += CONTROL_PACKET_1[0]; } else { ESP_LOGW(TAG, "Ignoring invalid power setting while building packet"); }
+        // wanted settings are indexes in the byte arrays: encoding is an array load
+        if (wantedSettings.power != PowerSetting_Unset) {
+            ESP_LOGD(TAG, "power -> %s", SAFE_STR(powerSettingToString(wantedSettings.power)));
+            packet[8] = POWER[wantedSettings.power];
+            packet[6] += CONTROL_PACKET_1[0];
         }
 
-        if (wantedSettings.mode != nullptr) {
-            ESP_LOGD(TAG, "heatpump mode -> %s", SAFE_STR(hpState.getModeSetting()));
-            int idx = lookupByteMapIndex(MODE_MAP, 5, hpState.getModeSetting(), "mode (write)");
-            if (idx >= 0) { packet[9] = MODE[idx]; packet[6] += CONTROL_PACKET_1[1]; } else { ESP_LOGW(TAG, "Ignoring invalid mode setting while building packet"); }
+        if (wantedSettings.mode != ModeSetting_Unset) {
+            ESP_LOGD(TAG, "heatpump mode -> %s", SAFE_STR(modeSettingToString(wantedSettings.mode)));
+            packet[9] = MODE[wantedSettings.mode];
+            packet[6] += CONTROL_PACKET_1[1];
         }
 
         if (wantedSettings.temperature != -1) {
             if (!hpState.getTempMode()) {
-                ESP_LOGD(TAG, "temperature (tempmode is false) -> %f", hpState.getTemperatureSetting());
-                int idx = lookupByteMapIndex(TEMP_MAP, 16, hpState.getTemperatureSetting(), "temperature (write)");
+                ESP_LOGD(TAG, "temperature (tempmode is false) -> %f", wantedSettings.temperature);
+                int idx = lookupByteMapIndex(TEMP_MAP_INDEX, wantedSettings.temperature, "temperature (write)");
                 if (idx >= 0) { packet[10] = TEMP[idx]; packet[6] += CONTROL_PACKET_1[2]; } else { ESP_LOGW(TAG, "Ignoring invalid temperature setting while building packet"); }
             } else {
-                ESP_LOGD(TAG, "temperature (tempmode is true) -> %f", hpState.getTemperatureSetting());
-                float temp = (hpState.getTemperatureSetting() * 2) + 128;
+                ESP_LOGD(TAG, "temperature (tempmode is true) -> %f", wantedSettings.temperature);
+                float temp = (wantedSettings.temperature * 2) + 128;
                 packet[19] = (int)temp;
                 packet[6] += CONTROL_PACKET_1[2];
             }
         }
 
-        if (wantedSettings.fan != nullptr) {
-            ESP_LOGD(TAG, "heatpump fan -> %s", SAFE_STR(hpState.getFanSpeedSetting()));
-            int idx = lookupByteMapIndex(FAN_MAP, 6, hpState.getFanSpeedSetting(), "fan (write)");
-            if (idx >= 0) { packet[11] = FAN[idx]; packet[6] += CONTROL_PACKET_1[3]; } else { ESP_LOGW(TAG, "Ignoring invalid fan setting while building packet"); }
+        if (wantedSettings.fan != FanSetting_Unset) {
+            ESP_LOGD(TAG, "heatpump fan -> %s", SAFE_STR(fanSettingToString(wantedSettings.fan)));
+            packet[11] = FAN[wantedSettings.fan];
+            packet[6] += CONTROL_PACKET_1[3];
         }
 
-        if (wantedSettings.vane != nullptr) {
-            ESP_LOGD(TAG, "heatpump vane -> %s", SAFE_STR(hpState.getVaneSetting()));
-            int idx = lookupByteMapIndex(VANE_MAP, 7, hpState.getVaneSetting(), "vane (write)");
-            if (idx >= 0) { packet[12] = VANE[idx]; packet[6] += CONTROL_PACKET_1[4]; } else { ESP_LOGW(TAG, "Ignoring invalid vane setting while building packet"); }
+        if (wantedSettings.vane != VaneSetting_Unset) {
+            ESP_LOGD(TAG, "heatpump vane -> %s", SAFE_STR(vaneSettingToString(wantedSettings.vane)));
+            packet[12] = VANE[wantedSettings.vane];
+            packet[6] += CONTROL_PACKET_1[4];
         }
 
-        if (wantedSettings.wideVane != nullptr) {
-            ESP_LOGD(TAG, "heatpump widevane -> %s", SAFE_STR(hpState.getWideVaneSetting()));
-            int idx = lookupByteMapIndex(WIDEVANE_MAP, 8, hpState.getWideVaneSetting(), "wideVane (write)");
-            if (idx >= 0) { packet[18] = WIDEVANE[idx] | (hpState.shouldWideVaneAdj() ? 0x80 : 0x00); packet[7] += CONTROL_PACKET_2[0]; } else { ESP_LOGW(TAG, "Ignoring invalid wideVane setting while building packet"); }
+        if (wantedSettings.wideVane != WideVaneSetting_Unset) {
+            // airflow control needs the i-See sensor, otherwise falls back to the current setting (unknown before the first 0x02 reply)
+            const heatpumpSettings& currentSettings = hpState.getCurrentSettings();
+            const WideVaneSetting wideVane = (wantedSettings.wideVane == WideVaneSetting_AirflowControl && !currentSettings.iSee) ?
+                currentSettings.wideVane : wantedSettings.wideVane;
+            ESP_LOGD(TAG, "heatpump widevane -> %s", SAFE_STR(wideVaneSettingToString(wideVane)));
+            if (wideVane != WideVaneSetting_Unset) { packet[18] = WIDEVANE[wideVane] | (hpState.shouldWideVaneAdj() ? 0x80 : 0x00); packet[7] += CONTROL_PACKET_2[0]; } else { ESP_LOGW(TAG, "Ignoring invalid wideVane setting while building packet"); }
         }
 
         // add the checksum
@@ -112,17 +115,16 @@ namespace devicestate {
 
     void CN105Protocol::parseSettings0x02(uint8_t* packet, CN105State &hpState) {
         heatpumpSettings receivedSettings{};
-        heatpumpRunStates receivedRunStates{};
         ESP_LOGD("Decoder", "[0x02 is settings]");
 
         receivedSettings.connected = true;
-        receivedSettings.power = lookupByteMapValue(POWER_MAP, POWER, 2, packet[3], "power reading");
+        receivedSettings.power = static_cast<PowerSetting>(lookupByteIndex(POWER_INDEX, packet[3], "power reading"));
         receivedSettings.iSee = packet[4] > 0x08 ? true : false;
-        receivedSettings.mode = lookupByteMapValue(MODE_MAP, MODE, 5, receivedSettings.iSee ? (packet[4] - 0x08) : packet[4], "mode reading");
+        receivedSettings.mode = static_cast<ModeSetting>(lookupByteIndex(MODE_INDEX, receivedSettings.iSee ? (packet[4] - 0x08) : packet[4], "mode reading"));
 
-        ESP_LOGD("Decoder", "[Power : %s]", SAFE_STR(receivedSettings.power));
+        ESP_LOGD("Decoder", "[Power : %s]", SAFE_STR(powerSettingToString(receivedSettings.power)));
         ESP_LOGD("Decoder", "[iSee  : %d]", receivedSettings.iSee);
-        ESP_LOGD("Decoder", "[Mode  : %s]", SAFE_STR(receivedSettings.mode));
+        ESP_LOGD("Decoder", "[Mode  : %s]", SAFE_STR(modeSettingToString(receivedSettings.mode)));
 
         if (packet[11] != 0x00) {
             int temp = packet[11];
@@ -130,31 +132,32 @@ namespace devicestate {
             receivedSettings.temperature = (float)temp / 2;
             hpState.setTempMode(true);
         } else {
-            receivedSettings.temperature = lookupByteMapValue(TEMP_MAP, TEMP, 16, packet[5], "temperature reading");
+            receivedSettings.temperature = lookupByteMapValue(TEMP_MAP, TEMP_INDEX, packet[5], "temperature reading");
         }
 
         ESP_LOGD("Decoder", "[Temp °C: %f]", receivedSettings.temperature);
 
-        receivedSettings.fan = lookupByteMapValue(FAN_MAP, FAN, 6, packet[6], "fan reading");
-        ESP_LOGD("Decoder", "[Fan: %s]", SAFE_STR(receivedSettings.fan));
+        receivedSettings.fan = static_cast<FanSetting>(lookupByteIndex(FAN_INDEX, packet[6], "fan reading"));
+        ESP_LOGD("Decoder", "[Fan: %s]", SAFE_STR(fanSettingToString(receivedSettings.fan)));
 
-        receivedSettings.vane = lookupByteMapValue(VANE_MAP, VANE, 7, packet[7], "vane reading");
-        ESP_LOGD("Decoder", "[Vane: %s]", SAFE_STR(receivedSettings.vane));
+        receivedSettings.vane = static_cast<VaneSetting>(lookupByteIndex(VANE_INDEX, packet[7], "vane reading"));
+        ESP_LOGD("Decoder", "[Vane: %s]", SAFE_STR(vaneSettingToString(receivedSettings.vane)));
 
         // --- START OF MODIFIED SECTION - Reverted widevane section back to more or less original state
         if (packet[10] != 0) {    // wideVane is not always supported
-            receivedSettings.wideVane = lookupByteMapValue(WIDEVANE_MAP, WIDEVANE, 8, packet[10] & 0x0F, "wideVane reading");
+            receivedSettings.wideVane = static_cast<WideVaneSetting>(lookupByteIndex(WIDEVANE_INDEX, packet[10] & 0x0F, "wideVane reading"));
             hpState.setWideVaneAdj((packet[10] & 0xF0) == 0x80 ? true : false);
-            ESP_LOGD("Decoder", "[wideVane: %s (adj:%d)]", SAFE_STR(receivedSettings.wideVane), hpState.shouldWideVaneAdj());
+            ESP_LOGD("Decoder", "[wideVane: %s (adj:%d)]", SAFE_STR(wideVaneSettingToString(receivedSettings.wideVane)), hpState.shouldWideVaneAdj());
         }
         // --- END OF MODIFIED SECTION ---
 
         // --- AIRFLOW CONTROL START
         /*
+        heatpumpRunStates receivedRunStates{};
         if (this->airflow_control_select_ != nullptr) {
             if (packet[10] == 0x80) {
                 if (receivedSettings.iSee) {
-                    receivedRunStates.airflow_control = lookupByteMapValue(AIRFLOW_CONTROL_MAP, AIRFLOW_CONTROL, 3, packet[14], "airflow control reading");
+                    receivedRunStates.airflow_control = lookupByteMapValue(AIRFLOW_CONTROL_MAP, AIRFLOW_CONTROL_INDEX, packet[14], "airflow control reading");
                 } else {
                     // For some reason packet[10] is 0x80, but the i-See sensor is not active. 
                     // Some units let us do this, but the real mode is unknown (might be powersave) and the i-See sensor does not get activated.
@@ -199,7 +202,7 @@ namespace devicestate {
             receivedStatus.roomTemperature = temp / 2.0f;
             ESP_LOGD(LOG_TEMP_SENSOR_TAG, "packet[6]  --> [Room °C: %f]", receivedStatus.roomTemperature);
         } else {
-            receivedStatus.roomTemperature = lookupByteMapValue(ROOM_TEMP_MAP, ROOM_TEMP, 32, packet[3]);
+            receivedStatus.roomTemperature = lookupByteMapValue(ROOM_TEMP_MAP, ROOM_TEMP_INDEX, packet[3]);
             ESP_LOGD(LOG_TEMP_SENSOR_TAG, "packet[3] map --> [Room °C : %f]", receivedStatus.roomTemperature);
         }
 
@@ -220,7 +223,7 @@ namespace devicestate {
 
     void CN105Protocol::parseTimers0x05(uint8_t* packet, CN105State& hpState) {
         heatpumpTimers receivedTimers;
-        receivedTimers.mode                = lookupByteMapValue(TIMER_MODE_MAP, TIMER_MODE, 4, packet[3]);
+        receivedTimers.mode                = lookupByteMapValue(TIMER_MODE_MAP, TIMER_MODE_INDEX, packet[3]);
         receivedTimers.onMinutesSet        = packet[4] * TIMER_INCREMENT_MINUTES;
         receivedTimers.onMinutesRemaining  = packet[6] * TIMER_INCREMENT_MINUTES;
         receivedTimers.offMinutesSet       = packet[5] * TIMER_INCREMENT_MINUTES;
@@ -16,7 +16,8 @@ namespace devicestate {
             void prepareSetPacket(uint8_t* packet, int length);
             void createInfoPacket(uint8_t* packet, uint8_t code);
             void prepareInfoPacket(uint8_t* packet, int length);
-            void createPacket(uint8_t* packet, CN105State& hpState);
+            // set packet of the wanted settings snapshot, hpState only gives the temperature mode and the current settings
+            void createPacket(uint8_t* packet, CN105State& hpState, const wantedHeatpumpSettings& wantedSettings);
             // Write Protocol
 
             // Read Protocol
@@ -60,7 +60,52 @@ namespace devicestate {
     }
 
     void CN105State::resetWantedSettings() {
+        this->beginWantedSettingsUpdate();
         this->wantedSettings.resetSettings();
+        this->endWantedSettingsUpdate();
+    }
+
+    /**
+     * The control path (climate calls, DeviceStateManager, workflows) and the bus
+     * path both run on the component loop: a write section only bumps the sequence,
+     * it never waits. The bus path copies the wanted settings, checks the sequence did
+     * not move during the copy, and clears them after the write only if it still did
+     * not, so a demand made meanwhile is kept for the next write instead of lost.
+    */
+    void CN105State::beginWantedSettingsUpdate() {
+        if (this->wantedWriteDepth_++ == 0) {
+            this->wantedSequence_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+    }
+
+    void CN105State::endWantedSettingsUpdate() {
+        if (this->wantedWriteDepth_ > 0 && --this->wantedWriteDepth_ == 0) {
+            this->wantedSequence_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    bool CN105State::snapshotWantedSettings(wantedHeatpumpSettings& out, uint32_t& sequence) {
+        const uint32_t before = this->wantedSequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        out = this->wantedSettings;
+        out.lastChange = this->wantedSettings.lastChange;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (this->wantedSequence_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        sequence = before;
+        return true;
+    }
+
+    bool CN105State::consumeWantedSettings(uint32_t sequence) {
+        if (this->wantedSequence_.load(std::memory_order_acquire) != sequence) {
+            return false;
+        }
+        this->resetWantedSettings();
+        return true;
     }
 
     heatpumpRunStates& CN105State::getCurrentRunStates() {
@@ -75,16 +120,16 @@ namespace devicestate {
         this->wantedRunStates.resetSettings();
     }
 
-    const char* CN105State::getModeSetting() {
-        if (this->wantedSettings.mode) {
+    ModeSetting CN105State::getModeSetting() {
+        if (this->wantedSettings.mode != ModeSetting_Unset) {
             return this->wantedSettings.mode;
         } else {
             return this->currentSettings.mode;
         }
     }
 
-    const char* CN105State::getPowerSetting() {
-        if (this->wantedSettings.power) {
+    PowerSetting CN105State::getPowerSetting() {
+        if (this->wantedSettings.power != PowerSetting_Unset) {
             return this->wantedSettings.power;
         } else {
             return this->currentSettings.power;
@@ -92,21 +137,24 @@ namespace devicestate {
     }
 
      bool CN105State::getPowerSettingBool() {
-        return this->getPowerSetting() == POWER_MAP[1];
+        return this->getPowerSetting() == PowerSetting_On;
     }
 
-    const char* CN105State::getVaneSetting() {
-        if (this->wantedSettings.vane) {
+    VaneSetting CN105State::getVaneSetting() {
+        if (this->wantedSettings.vane != VaneSetting_Unset) {
             return this->wantedSettings.vane;
         } else {
             return this->currentSettings.vane;
         }
     }
 
-    const char* CN105State::getWideVaneSetting() {
-        if (this->wantedSettings.wideVane) {
-            if (strcmp(this->wantedSettings.wideVane, lookupByteMapValue(WIDEVANE_MAP, WIDEVANE, 8, 0x80 & 0x0F)) == 0 && !this->currentSettings.iSee) {
+    WideVaneSetting CN105State::getWideVaneSetting() {
+        if (this->wantedSettings.wideVane != WideVaneSetting_Unset) {
+            // airflow control (wide vane byte 0x00) needs the i-See sensor
+            if (this->wantedSettings.wideVane == WideVaneSetting_AirflowControl && !this->currentSettings.iSee) {
+                this->beginWantedSettingsUpdate();
                 this->wantedSettings.wideVane = this->currentSettings.wideVane;
+                this->endWantedSettingsUpdate();
             }
             return this->wantedSettings.wideVane;
         } else {
@@ -114,8 +162,8 @@ namespace devicestate {
         }
     }
 
-    const char* CN105State::getFanSpeedSetting() {
-        if (this->wantedSettings.fan) {
+    FanSetting CN105State::getFanSpeedSetting() {
+        if (this->wantedSettings.fan != FanSetting_Unset) {
             return this->wantedSettings.fan;
         } else {
             return this->currentSettings.fan;
@@ -162,53 +210,34 @@ namespace devicestate {
         }
     }
 
-    void CN105State::setModeSetting(const char* setting) {
-        int index = lookupByteMapIndex(MODE_MAP, 5, setting);
-        if (index > -1) {
-            wantedSettings.mode = MODE_MAP[index];
-        } else {
-            wantedSettings.mode = MODE_MAP[0];
-        }
+    void CN105State::setModeSetting(ModeSetting setting) {
+        this->beginWantedSettingsUpdate();
+        wantedSettings.mode = setting;
+        this->endWantedSettingsUpdate();
     }
 
     void CN105State::setPowerSetting(bool setting) {
-        wantedSettings.power = lookupByteMapIndex(POWER_MAP, 2, POWER_MAP[setting ? 1 : 0]) > -1 ? POWER_MAP[setting ? 1 : 0] : POWER_MAP[0];
+        this->beginWantedSettingsUpdate();
+        wantedSettings.power = setting ? PowerSetting_On : PowerSetting_Off;
+        this->endWantedSettingsUpdate();
     }
 
-    void CN105State::setPowerSetting(const char* setting) {
-        int index = lookupByteMapIndex(POWER_MAP, 2, setting);
-        if (index > -1) {
-            wantedSettings.power = POWER_MAP[index];
-        } else {
-            wantedSettings.power = POWER_MAP[0];
-        }
+    void CN105State::setFanSpeed(FanSetting setting) {
+        this->beginWantedSettingsUpdate();
+        wantedSettings.fan = setting;
+        this->endWantedSettingsUpdate();
     }
 
-    void CN105State::setFanSpeed(const char* setting) {
-        int index = lookupByteMapIndex(FAN_MAP, 6, setting);
-        if (index > -1) {
-            wantedSettings.fan = FAN_MAP[index];
-        } else {
-            wantedSettings.fan = FAN_MAP[0];
-        }
+    void CN105State::setVaneSetting(VaneSetting setting) {
+        this->beginWantedSettingsUpdate();
+        wantedSettings.vane = setting;
+        this->endWantedSettingsUpdate();
     }
 
-    void CN105State::setVaneSetting(const char* setting) {
-        int index = lookupByteMapIndex(VANE_MAP, 7, setting);
-        if (index > -1) {
-            wantedSettings.vane = VANE_MAP[index];
-        } else {
-            wantedSettings.vane = VANE_MAP[0];
-        }
-    }
-
-    void CN105State::setWideVaneSetting(const char* setting) {
-        int index = lookupByteMapIndex(WIDEVANE_MAP, 8, setting);
-        if (index > -1) {
-            wantedSettings.wideVane = WIDEVANE_MAP[index];
-        } else {
-            wantedSettings.wideVane = WIDEVANE_MAP[0];
-        }
+    void CN105State::setWideVaneSetting(WideVaneSetting setting) {
+        this->beginWantedSettingsUpdate();
+        wantedSettings.wideVane = setting;
+        this->endWantedSettingsUpdate();
     }
 
     void CN105State::setAirflowControlSetting(const char* setting) {
@@ -223,7 +252,7 @@ namespace devicestate {
     void CN105State::setTemperature(float setting) {
         float temperature;
         if(!this->getTempMode()){
-            temperature = lookupByteMapIndex(TEMP_MAP, 16, (int)(setting + 0.5)) > -1 ? setting : TEMP_MAP[0];
+            temperature = lookupByteMapIndex(TEMP_MAP_INDEX, (int)(setting + 0.5)) > -1 ? setting : TEMP_MAP[0];
         }
         else {
             setting = setting * 2;
@@ -231,7 +260,9 @@ namespace devicestate {
             setting = setting / 2;
             temperature = setting < 10 ? 10 : (setting > 31 ? 31 : setting);
         }
+        this->beginWantedSettingsUpdate();
         wantedSettings.temperature = temperature;
+        this->endWantedSettingsUpdate();
     }
 
     void CN105State::setRoomTemperature(float value) {
@@ -267,9 +298,11 @@ namespace devicestate {
     }
 
     void CN105State::onSettingsChanged() {
+        this->beginWantedSettingsUpdate();
         wantedSettings.hasChanged = true;
         wantedSettings.hasBeenSent = false;
         wantedSettings.lastChange = CUSTOM_MILLIS;
+        this->endWantedSettingsUpdate();
     }
 
     bool CN105State::isSettingsInitialized() {
@@ -288,7 +321,7 @@ namespace devicestate {
         //this->debugClimate("climate");
         //this->publishStateToHA(settings);
 
-        if ((this->wantedSettings.mode == nullptr) && (this->wantedSettings.power == nullptr)) {        // to prevent overwriting a user demand
+        if ((this->wantedSettings.mode == ModeSetting_Unset) && (this->wantedSettings.power == PowerSetting_Unset)) {        // to prevent overwriting a user demand
             if (this->hasChanged(currentSettings.power, settings.power, "power") ||
                    this->hasChanged(currentSettings.mode, settings.mode, "mode")) {           // mode or power change ?
                 ESP_LOGI(TAG, "power or mode changed");
@@ -299,21 +332,21 @@ namespace devicestate {
 
         //this->updateAction();       // update action info on HA climate component
 
-        if (this->wantedSettings.fan == nullptr) {  // to prevent overwriting a user demand
+        if (this->wantedSettings.fan == FanSetting_Unset) {  // to prevent overwriting a user demand
             if (this->hasChanged(currentSettings.fan, settings.fan, "fan")) { // fan setting change ?
                 ESP_LOGI(TAG, "fan setting changed");
                 currentSettings.fan = settings.fan;
             }
         }
 
-        if (this->wantedSettings.vane == nullptr) { // to prevent overwriting a user demand
+        if (this->wantedSettings.vane == VaneSetting_Unset) { // to prevent overwriting a user demand
             if (this->hasChanged(currentSettings.vane, settings.vane, "vane")) {    // widevane setting change ?
                 ESP_LOGI(TAG, "vane setting changed");
                 currentSettings.vane = settings.vane;
             }
         }
 
-        if (this->wantedSettings.wideVane == nullptr) { // to prevent overwriting a user demand
+        if (this->wantedSettings.wideVane == WideVaneSetting_Unset) { // to prevent overwriting a user demand
             if (this->hasChanged(currentSettings.wideVane, settings.wideVane, "wideVane")) {    // widevane setting change ?
                 ESP_LOGI(TAG, "vane setting changed");
                 currentSettings.wideVane = settings.wideVane;
@@ -370,16 +403,16 @@ namespace devicestate {
     }
 
 
-    bool CN105State::hasChanged(const char* before, const char* now, const char* field, bool checkNotNull) {
-        if (now == NULL) {
+    bool CN105State::hasChanged(uint8_t before, uint8_t now, const char* field, bool checkNotNull) {
+        if (now == SETTING_UNSET) {
             if (checkNotNull) {
-                ESP_LOGE(TAG, "CAUTION: expected value in hasChanged() function for %s, got NULL", field);
+                ESP_LOGE(TAG, "CAUTION: expected value in hasChanged() function for %s, got none", field);
             } else {
                 ESP_LOGD(TAG, "No value in hasChanged() function for %s", field);
             }
             return false;
         }
-        return ((before == NULL) || (strcmp(before, now) != 0));
+        return before != now;
     }
 
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "cn105_types.h"
 #include "cn105_utils.h"
 #include "heatpumpFunctions.h"
@@ -12,6 +14,9 @@ namespace devicestate {
         private:
             heatpumpSettings currentSettings{};
             wantedHeatpumpSettings wantedSettings{};
+            // sequence lock over wantedSettings: odd while they are being written
+            std::atomic<uint32_t> wantedSequence_{ 0 };
+            uint8_t wantedWriteDepth_ = 0;
 
             // initialise to all off, then it will update shortly after connect;
             heatpumpStatus currentStatus{ 0, 0, false, {TIMER_MODE_MAP[0], 0, 0, 0, 0}, 0, 0, 0, 0 };
@@ -27,7 +32,7 @@ namespace devicestate {
             bool settingsInitialized = false;
             bool statusInitialized = false;
 
-            bool hasChanged(const char* before, const char* now, const char* field, bool checkNotNull = false);
+            bool hasChanged(uint8_t before, uint8_t now, const char* field, bool checkNotNull = false);
 
         public:
             CN105State();
@@ -41,6 +46,14 @@ namespace devicestate {
             wantedHeatpumpSettings& getWantedSettings();
             void resetWantedSettings();
 
+            // write section over the wanted settings (nestable, single writer), never waits
+            void beginWantedSettingsUpdate();
+            void endWantedSettingsUpdate();
+            // consistent copy for the bus path, false while a write section is open
+            bool snapshotWantedSettings(wantedHeatpumpSettings& out, uint32_t& sequence);
+            // resets the wanted settings once written, unless a newer demand came in since the snapshot
+            bool consumeWantedSettings(uint32_t sequence);
+
             heatpumpStatus& getCurrentStatus();
             void updateCurrentStatus(heatpumpStatus& currentStatus);
             bool isStatusInitialized();
@@ -59,14 +72,14 @@ namespace devicestate {
             bool getTempMode();
             void setTempMode(bool value);
 
-            const char* getModeSetting();
-            const char* getPowerSetting();
+            ModeSetting getModeSetting();
+            PowerSetting getPowerSetting();
             bool getPowerSettingBool();
 
-            const char* getVaneSetting();
-            const char* getWideVaneSetting();
+            VaneSetting getVaneSetting();
+            WideVaneSetting getWideVaneSetting();
             const char* getAirflowControlSetting();
-            const char* getFanSpeedSetting();
+            FanSetting getFanSpeedSetting();
 
             float getTemperatureSetting();
             bool getAirPurifierRunState();
@@ -74,13 +87,12 @@ namespace devicestate {
             
             bool getCirculatorRunState();
 
-            void setModeSetting(const char* setting);
+            void setModeSetting(ModeSetting setting);
             void setPowerSetting(bool setting);
-            void setPowerSetting(const char* setting);
-            void setVaneSetting(const char* setting);
-            void setWideVaneSetting(const char* setting);
+            void setVaneSetting(VaneSetting setting);
+            void setWideVaneSetting(WideVaneSetting setting);
             void setAirflowControlSetting(const char* setting);
-            void setFanSpeed(const char* setting);
+            void setFanSpeed(FanSetting setting);
             void setTemperature(float setting);
 
             void setRoomTemperature(float value);
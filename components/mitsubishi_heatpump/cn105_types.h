@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <cmath>
 #include <cstring>
@@ -11,26 +12,39 @@ namespace devicestate {
     #define MAX_DATA_BYTES     64         
     #define MAX_DELAY_RESPONSE_FACTOR 10  
 
-    static const char* LOG_ACTION_EVT_TAG = "EVT_SETS";
-    static const char* LOG_REMOTE_TEMP = "REMOTE_TEMP"; 
-    static const char* LOG_ACK = "ACK"; 
-    static const char* LOG_SETTINGS_TAG = "SETTINGS";   
-    static const char* LOG_STATUS_TAG = "STATUS";       
-    static const char* LOG_CYCLE_TAG = "CYCLE";         
-    static const char* LOG_UPD_INT_TAG = "UPDT_ITVL";   
-    static const char* LOG_SET_RUN_STATE = "SET_RUN_STATE";
-    static const char* LOG_OPERATING_STATUS_TAG = "OPERATING_STATUS"; 
-    static const char* LOG_TEMP_SENSOR_TAG = "TEMP_SENSOR"; 
-    static const char* LOG_DUAL_SP_TAG = "DUAL_SP"; 
-    static const char* LOG_FUNCTIONS_TAG = "FUNCTIONS"; 
-    static const char* LOG_HARDWARE_SELECT_TAG = "HardwareSelect";
-    static const char* LOG_CONN_TAG = "CN105_CONN";
-
-    static const char* SCHEDULER_REMOTE_TEMP_TIMEOUT = "->remote_temp_timeout";
+    static const char* const LOG_ACTION_EVT_TAG = "EVT_SETS";
+    static const char* const LOG_REMOTE_TEMP = "REMOTE_TEMP"; 
+    static const char* const LOG_ACK = "ACK"; 
+    static const char* const LOG_SETTINGS_TAG = "SETTINGS";   
+    static const char* const LOG_STATUS_TAG = "STATUS";       
+    static const char* const LOG_CYCLE_TAG = "CYCLE";         
+    static const char* const LOG_UPD_INT_TAG = "UPDT_ITVL";   
+    static const char* const LOG_SET_RUN_STATE = "SET_RUN_STATE";
+    static const char* const LOG_OPERATING_STATUS_TAG = "OPERATING_STATUS"; 
+    static const char* const LOG_TEMP_SENSOR_TAG = "TEMP_SENSOR"; 
+    static const char* const LOG_DUAL_SP_TAG = "DUAL_SP"; 
+    static const char* const LOG_FUNCTIONS_TAG = "FUNCTIONS"; 
+    static const char* const LOG_HARDWARE_SELECT_TAG = "HardwareSelect";
+    static const char* const LOG_CONN_TAG = "CN105_CONN";
+    static const char* const LOG_LATENCY_TAG = "LATENCY";
+    static const char* const LOG_CAPTURE_TAG = "CAPTURE";
+
+    static const char* const SCHEDULER_REMOTE_TEMP_TIMEOUT = "->remote_temp_timeout";
 
     static const int DEFER_SCHEDULE_UPDATE_LOOP_DELAY = 750;
+    static const uint32_t MIN_SEND_INTERVAL_MS = 300;         // gap between two frames sent to the heatpump (ceiling of the adaptive pacing)
+    static const uint32_t MIN_SEND_INTERVAL_FLOOR_MS = 100;   // floor of the adaptive pacing
     static const uint32_t RECEIVED_SETPOINT_GRACE_WINDOW_MS = 3000;
     static const uint32_t UI_SETPOINT_ANTIREBOUND_MS = 600;
+    static const uint32_t ADAPTIVE_POLL_MIN_BACKOFF_MS = 1000; // smallest back-off step of adaptive polling
+    static const uint8_t WRITE_CONFIRM_MAX_ATTEMPTS = 3;        // settings writes re-sent until read back, at most
+    static const uint32_t WRITE_CONFIRM_READ_TIMEOUT_MS = 1000; // read-back without answer after that
+    static const uint32_t WRITE_ACK_TIMEOUT_MS = 1000;          // 0x41 write without 0x61 ack after that is lost
+    static const uint8_t WRITE_MAX_RETRANSMITS = 2;             // a lost write is sent again that many times, at most
+    static const float REMOTE_TEMP_FAST_DELTA_DEFAULT = 1.0f;   // remote temperature step (°C) pushed without waiting for the cycle, 0: never
+    static const uint32_t REMOTE_TEMP_FAST_INTERVAL_DEFAULT_MS = 10000; // at most one such push per interval
+    static const uint32_t PUBLISH_HEARTBEAT_DEFAULT_MS = 60000; // unchanged sensors are published again after that, 0: never
+    static const uint32_t PUBLISH_BUDGET_DEFAULT_US = 5000;     // time given to the deferred publication per loop, 0: no limit
 
     static const int PACKET_LEN = 22;
     static const int PACKET_TYPE_DEFAULT = 99;
@@ -67,35 +81,78 @@ namespace devicestate {
     static const uint8_t CONTROL_PACKET_2[1] = { 0x01 };
     static const uint8_t RUN_STATE_PACKET_1[5] = { 0x01, 0x04, 0x08, 0x10, 0x20 };
     static const uint8_t RUN_STATE_PACKET_2[5] = { 0x02, 0x04, 0x08, 0x10, 0x20 };
-    static const uint8_t POWER[2] = { 0x00, 0x01 };
-    static const char* POWER_MAP[2] = { "OFF", "ON" };
-    static const uint8_t MODE[5] = { 0x01,   0x02,  0x03, 0x07, 0x08 };
-    static const char* MODE_MAP[5] = { "HEAT", "DRY", "COOL", "FAN", "AUTO" };
-    static const uint8_t TEMP[16] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
-    static const int TEMP_MAP[16] = { 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16 };
-    static const uint8_t FAN[6] = { 0x00,  0x01,   0x02, 0x03, 0x05, 0x06 };
-    static const char* FAN_MAP[6] = { "AUTO", "QUIET", "1", "2", "3", "4" };
-    static const uint8_t VANE[7] = { 0x00,  0x01, 0x02, 0x03, 0x04, 0x05, 0x07 };
-    static const char* VANE_MAP[7] = { "AUTO", "↑↑", "↑", "—", "↓", "↓↓", "SWING" };
-    static const uint8_t WIDEVANE[8] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x08, 0x0c, 0x00 };
-    static const char* WIDEVANE_MAP[8] = { "←←", "←", "|", "→", "→→", "←→", "SWING", "AIRFLOW CONTROL" };
-    static const uint8_t ROOM_TEMP[32] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    static constexpr uint8_t POWER[2] = { 0x00, 0x01 };
+    static const char* const POWER_MAP[2] = { "OFF", "ON" };
+    static constexpr uint8_t MODE[5] = { 0x01,   0x02,  0x03, 0x07, 0x08 };
+    static const char* const MODE_MAP[5] = { "HEAT", "DRY", "COOL", "FAN", "AUTO" };
+    static constexpr uint8_t TEMP[16] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+    static constexpr int TEMP_MAP[16] = { 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16 };
+    static constexpr uint8_t FAN[6] = { 0x00,  0x01,   0x02, 0x03, 0x05, 0x06 };
+    static const char* const FAN_MAP[6] = { "AUTO", "QUIET", "1", "2", "3", "4" };
+    static constexpr uint8_t VANE[7] = { 0x00,  0x01, 0x02, 0x03, 0x04, 0x05, 0x07 };
+    static const char* const VANE_MAP[7] = { "AUTO", "↑↑", "↑", "—", "↓", "↓↓", "SWING" };
+    static constexpr uint8_t WIDEVANE[8] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x08, 0x0c, 0x00 };
+    static const char* const WIDEVANE_MAP[8] = { "←←", "←", "|", "→", "→→", "←→", "SWING", "AIRFLOW CONTROL" };
+    static constexpr uint8_t ROOM_TEMP[32] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
                                     0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f };
-    static const int ROOM_TEMP_MAP[32] = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,
+    static constexpr int ROOM_TEMP_MAP[32] = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,
                                     26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41 };
-    static const uint8_t TIMER_MODE[4] = { 0x00,  0x01,  0x02, 0x03 };
-    static const char* TIMER_MODE_MAP[4] = { "NONE", "OFF", "ON", "BOTH" };
+    static constexpr uint8_t TIMER_MODE[4] = { 0x00,  0x01,  0x02, 0x03 };
+    static const char* const TIMER_MODE_MAP[4] = { "NONE", "OFF", "ON", "BOTH" };
 
-    static const uint8_t AIRFLOW_CONTROL[3] = { 0x00, 0x01, 0x02 };
-    static const char* AIRFLOW_CONTROL_MAP[3] = { "EVEN", "INDIRECT", "DIRECT" };
+    static constexpr uint8_t AIRFLOW_CONTROL[3] = { 0x00, 0x01, 0x02 };
+    static const char* const AIRFLOW_CONTROL_MAP[3] = { "EVEN", "INDIRECT", "DIRECT" };
 
     static const uint8_t STAGE[7] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
-    static const char* STAGE_MAP[7] = { "IDLE", "LOW", "GENTLE", "MEDIUM", "MODERATE", "HIGH", "DIFFUSE" };
+    static const char* const STAGE_MAP[7] = { "IDLE", "LOW", "GENTLE", "MEDIUM", "MODERATE", "HIGH", "DIFFUSE" };
 
     static const uint8_t SUB_MODE[4] = { 0x00, 0x02, 0x04, 0x08 };
-    static const char* SUB_MODE_MAP[4] = { "NORMAL", "DEFROST", "PREHEAT", "STANDBY" };
+    static const char* const SUB_MODE_MAP[4] = { "NORMAL", "DEFROST", "PREHEAT", "STANDBY" };
     static const uint8_t AUTO_SUB_MODE[4] = { 0x00, 0x01, 0x02, 0x03 };
-    static const char* AUTO_SUB_MODE_MAP[4] = { "AUTO_OFF","AUTO_COOL", "AUTO_HEAT", "AUTO_LEADER" };
+    static const char* const AUTO_SUB_MODE_MAP[4] = { "AUTO_OFF","AUTO_COOL", "AUTO_HEAT", "AUTO_LEADER" };
+
+    /**
+     * Reverse lookup table: position[v] is the index of v in one of the
+     * arrays above, -1 when v is absent. Built at compile time so decoding a
+     * byte (or encoding a temperature) is a single array load.
+     */
+    struct ByteIndex {
+        int8_t position[256];
+
+        constexpr int find(int value) const {
+            return (value < 0 || value > 255) ? -1 : this->position[value];
+        }
+    };
+
+    // values must fit in 0..255, anything else fails the constant evaluation
+    template <typename T, size_t N>
+    constexpr ByteIndex makeByteIndex(const T (&values)[N]) {
+        ByteIndex table{};
+        for (int v = 0; v < 256; v++) {
+            table.position[v] = -1;
+        }
+        // backwards, so the first occurrence wins like the former linear scans
+        for (int i = static_cast<int>(N) - 1; i >= 0; i--) {
+            table.position[values[i]] = static_cast<int8_t>(i);
+        }
+        return table;
+    }
+
+    // inline: one copy of each table in the firmware, not one per translation unit
+    inline constexpr ByteIndex POWER_INDEX = makeByteIndex(POWER);
+    inline constexpr ByteIndex MODE_INDEX = makeByteIndex(MODE);
+    inline constexpr ByteIndex TEMP_INDEX = makeByteIndex(TEMP);
+    inline constexpr ByteIndex TEMP_MAP_INDEX = makeByteIndex(TEMP_MAP);
+    inline constexpr ByteIndex FAN_INDEX = makeByteIndex(FAN);
+    inline constexpr ByteIndex VANE_INDEX = makeByteIndex(VANE);
+    inline constexpr ByteIndex WIDEVANE_INDEX = makeByteIndex(WIDEVANE);
+    inline constexpr ByteIndex ROOM_TEMP_INDEX = makeByteIndex(ROOM_TEMP);
+    inline constexpr ByteIndex TIMER_MODE_INDEX = makeByteIndex(TIMER_MODE);
+    inline constexpr ByteIndex AIRFLOW_CONTROL_INDEX = makeByteIndex(AIRFLOW_CONTROL);
+
+    static_assert(FAN_INDEX.find(0x05) == 4, "FAN_INDEX out of sync with FAN");
+    static_assert(WIDEVANE_INDEX.find(0x00) == 7, "WIDEVANE_INDEX out of sync with WIDEVANE");
+    static_assert(TEMP_MAP_INDEX.find(16) == 15, "TEMP_MAP_INDEX out of sync with TEMP_MAP");
 
     static const int TIMER_INCREMENT_MINUTES = 10;
 
@@ -108,30 +165,92 @@ namespace devicestate {
     const uint8_t ESPMHP_MAX_TEMPERATURE = 26;
     const float ESPMHP_TEMPERATURE_STEP = 0.5;
 
+    /**
+     * Settings are held as the index of their entry in the arrays above:
+     * POWER[power] is the protocol byte, POWER_MAP[power] its label. Labels
+     * are only looked up for logs and the UI (powerSettingToString()...).
+     * SETTING_UNSET marks a setting not received yet, or not wanted.
+     */
+    static const uint8_t SETTING_UNSET = 0xFF;
+
+    enum PowerSetting : uint8_t {
+        PowerSetting_Off,
+        PowerSetting_On,
+        PowerSetting_Unset = SETTING_UNSET
+    };
+
+    enum ModeSetting : uint8_t {
+        ModeSetting_Heat,
+        ModeSetting_Dry,
+        ModeSetting_Cool,
+        ModeSetting_Fan,
+        ModeSetting_Auto,
+        ModeSetting_Unset = SETTING_UNSET
+    };
+
+    enum FanSetting : uint8_t {
+        FanSetting_Auto,
+        FanSetting_Quiet,
+        FanSetting_Speed1,
+        FanSetting_Speed2,
+        FanSetting_Speed3,
+        FanSetting_Speed4,
+        FanSetting_Unset = SETTING_UNSET
+    };
+
+    enum VaneSetting : uint8_t {
+        VaneSetting_Auto,
+        VaneSetting_Up,
+        VaneSetting_UpCenter,
+        VaneSetting_Center,
+        VaneSetting_DownCenter,
+        VaneSetting_Down,
+        VaneSetting_Swing,
+        VaneSetting_Unset = SETTING_UNSET
+    };
+
+    enum WideVaneSetting : uint8_t {
+        WideVaneSetting_Left,
+        WideVaneSetting_LeftCenter,
+        WideVaneSetting_Center,
+        WideVaneSetting_RightCenter,
+        WideVaneSetting_Right,
+        WideVaneSetting_LeftRight,
+        WideVaneSetting_Swing,
+        WideVaneSetting_AirflowControl,
+        WideVaneSetting_Unset = SETTING_UNSET
+    };
+
+    static_assert(PowerSetting_On + 1 == sizeof(POWER), "PowerSetting out of sync with POWER");
+    static_assert(ModeSetting_Auto + 1 == sizeof(MODE), "ModeSetting out of sync with MODE");
+    static_assert(FanSetting_Speed4 + 1 == sizeof(FAN), "FanSetting out of sync with FAN");
+    static_assert(VaneSetting_Swing + 1 == sizeof(VANE), "VaneSetting out of sync with VANE");
+    static_assert(WideVaneSetting_AirflowControl + 1 == sizeof(WIDEVANE), "WideVaneSetting out of sync with WIDEVANE");
+
     struct heatpumpSettings {
-        const char* power;
-        const char* mode;
         float temperature;
         float dual_low_target;
         float dual_high_target;
-        const char* fan;
-        const char* vane;
-        const char* wideVane;
+        PowerSetting power = PowerSetting_Unset;
+        ModeSetting mode = ModeSetting_Unset;
+        FanSetting fan = FanSetting_Unset;
+        VaneSetting vane = VaneSetting_Unset;
+        WideVaneSetting wideVane = WideVaneSetting_Unset;
         bool iSee;
         bool connected;
-        const char* stage;
-        const char* sub_mode;
-        const char* auto_sub_mode;
+        uint8_t stage = SETTING_UNSET;          // index in STAGE_MAP
+        uint8_t sub_mode = SETTING_UNSET;       // index in SUB_MODE_MAP
+        uint8_t auto_sub_mode = SETTING_UNSET;  // index in AUTO_SUB_MODE_MAP
 
         void resetSettings() {
-            power = nullptr;
-            mode = nullptr;
+            power = PowerSetting_Unset;
+            mode = ModeSetting_Unset;
             temperature = -1.0f;
             dual_low_target = -100.0f;
             dual_high_target = -100.0f;
-            fan = nullptr;
-            vane = nullptr;
-            wideVane = nullptr;
+            fan = FanSetting_Unset;
+            vane = VaneSetting_Unset;
+            wideVane = WideVaneSetting_Unset;
         }
 
         heatpumpSettings& operator=(const heatpumpSettings& other) {
@@ -16,21 +16,24 @@ namespace devicestate {
         return (0xfc - sum) & 0xff;
     }
 
-    int lookupByteMapIndex(const int valuesMap[], int len, int lookupValue, const char* debugInfo) {
-        for (int i = 0; i < len; i++) {
-            if (valuesMap[i] == lookupValue) {
-                return i;
-            }
+    int lookupByteMapIndex(const ByteIndex& valueIndex, int lookupValue, const char* debugInfo) {
+        const int index = valueIndex.find(lookupValue);
+        if (index < 0) {
+            ESP_LOGW(TAG, "%s caution value %d not found, returning -1", debugInfo, lookupValue);
         }
-        ESP_LOGW(TAG, "%s caution value %d not found, returning -1", debugInfo, lookupValue);
-        return -1;
+        return index;
     }
 
-    int lookupByteMapIndex(const char* valuesMap[], int len, const char* lookupValue, const char* debugInfo) {
+    int lookupByteMapIndex(const char* const valuesMap[], int len, const char* lookupValue, const char* debugInfo) {
         if (lookupValue == nullptr) {
             ESP_LOGW(TAG, "%s caution: lookupValue is null, returning -1", debugInfo);
             return -1;
         }
+        for (int i = 0; i < len; i++) {
+            if (valuesMap[i] == lookupValue) {
+                return i;
+            }
+        }
         for (int i = 0; i < len; i++) {
             if (strcasecmp(valuesMap[i], lookupValue) == 0) {
                 return i;
@@ -40,11 +43,10 @@ namespace devicestate {
         return -1;
     }
 
-    const char* lookupByteMapValue(const char* valuesMap[], const uint8_t byteMap[], int len, uint8_t byteValue, const char* debugInfo, const char* defaultValue) {
-        for (int i = 0; i < len; i++) {
-            if (byteMap[i] == byteValue) {
-                return valuesMap[i];
-            }
+    const char* lookupByteMapValue(const char* const valuesMap[], const ByteIndex& byteIndex, uint8_t byteValue, const char* debugInfo, const char* defaultValue) {
+        const int index = byteIndex.position[byteValue];
+        if (index >= 0) {
+            return valuesMap[index];
         }
 
         if (defaultValue != nullptr) {
@@ -56,16 +58,48 @@ namespace devicestate {
 
     }
 
-    int lookupByteMapValue(const int valuesMap[], const uint8_t byteMap[], int len, uint8_t byteValue, const char* debugInfo) {
-        for (int i = 0; i < len; i++) {
-            if (byteMap[i] == byteValue) {
-                return valuesMap[i];
-            }
+    int lookupByteMapValue(const int valuesMap[], const ByteIndex& byteIndex, uint8_t byteValue, const char* debugInfo) {
+        const int index = byteIndex.position[byteValue];
+        if (index >= 0) {
+            return valuesMap[index];
         }
         ESP_LOGW(TAG, "%s caution: value %d not found, returning value at index 0", debugInfo, byteValue);
         return valuesMap[0];
     }
 
+    uint8_t lookupByteIndex(const ByteIndex& byteIndex, uint8_t byteValue, const char* debugInfo) {
+        const int index = byteIndex.position[byteValue];
+        if (index >= 0) {
+            return static_cast<uint8_t>(index);
+        }
+        ESP_LOGW(TAG, "%s caution: value %d not found, returning value at index 0", debugInfo, byteValue);
+        return 0;
+    }
+
+    static const char* settingLabel(const char* const valuesMap[], size_t len, uint8_t setting) {
+        return setting < len ? valuesMap[setting] : nullptr;
+    }
+
+    const char* powerSettingToString(PowerSetting setting) {
+        return settingLabel(POWER_MAP, sizeof(POWER), setting);
+    }
+
+    const char* modeSettingToString(ModeSetting setting) {
+        return settingLabel(MODE_MAP, sizeof(MODE), setting);
+    }
+
+    const char* fanSettingToString(FanSetting setting) {
+        return settingLabel(FAN_MAP, sizeof(FAN), setting);
+    }
+
+    const char* vaneSettingToString(VaneSetting setting) {
+        return settingLabel(VANE_MAP, sizeof(VANE), setting);
+    }
+
+    const char* wideVaneSettingToString(WideVaneSetting setting) {
+        return settingLabel(WIDEVANE_MAP, sizeof(WIDEVANE), setting);
+    }
+
     const char* getIfNotNull(const char* what, const char* defaultValue) {
         if (what == NULL) {
             return defaultValue;
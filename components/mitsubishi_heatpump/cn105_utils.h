@@ -9,10 +9,21 @@ namespace devicestate {
 
     uint8_t checkSum(uint8_t bytes[], int len);
 
-    const char* lookupByteMapValue(const char* valuesMap[], const uint8_t byteMap[], int len, uint8_t byteValue, const char* debugInfo = "", const char* defaultValue = nullptr);
-    int lookupByteMapValue(const int valuesMap[], const uint8_t byteMap[], int len, uint8_t byteValue, const char* debugInfo = "");
-    int lookupByteMapIndex(const char* valuesMap[], int len, const char* lookupValue, const char* debugInfo = "");
-    int lookupByteMapIndex(const int valuesMap[], int len, int lookupValue, const char* debugInfo = "");
+    // byte -> value, through the compile-time reverse tables of cn105_types.h (POWER_INDEX, FAN_INDEX...)
+    const char* lookupByteMapValue(const char* const valuesMap[], const ByteIndex& byteIndex, uint8_t byteValue, const char* debugInfo = "", const char* defaultValue = nullptr);
+    int lookupByteMapValue(const int valuesMap[], const ByteIndex& byteIndex, uint8_t byteValue, const char* debugInfo = "");
+    // setting -> index; settings held by CN105State point into the maps, so they match without strcasecmp
+    int lookupByteMapIndex(const char* const valuesMap[], int len, const char* lookupValue, const char* debugInfo = "");
+    int lookupByteMapIndex(const ByteIndex& valueIndex, int lookupValue, const char* debugInfo = "");
+    // byte -> setting index, 0 with a warning when the byte is unknown (same fallback as lookupByteMapValue)
+    uint8_t lookupByteIndex(const ByteIndex& byteIndex, uint8_t byteValue, const char* debugInfo = "");
+
+    // labels of the settings for logs and the UI, nullptr while unset
+    const char* powerSettingToString(PowerSetting setting);
+    const char* modeSettingToString(ModeSetting setting);
+    const char* fanSettingToString(FanSetting setting);
+    const char* vaneSettingToString(VaneSetting setting);
+    const char* wideVaneSettingToString(WideVaneSetting setting);
 
     const char* getIfNotNull(const char* what, const char* defaultValue);
 
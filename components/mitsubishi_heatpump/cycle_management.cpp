@@ -1,9 +1,11 @@
 #include "cycle_management.h"
 
 #include "Globals.h"
+#include "cn105_types.h"
 #include "logging.h"
 
 using namespace esphome;
+using namespace devicestate;
 
 static const char* TAG = "cycleManagement"; // Logging tag
 
@@ -27,13 +29,17 @@ void cycleManagement::init() {
     lastCompleteCycleMs = CUSTOM_MILLIS;
 }
 
-void cycleManagement::deferCycle() {
+void cycleManagement::deferCycle(uint32_t measuredDelay) {
 
+    // a measured write latency already accounts for the logging overhead
+    uint32_t delay = measuredDelay;
+    if (delay == 0) {
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
-    uint32_t delay = DEFER_SCHEDULE_UPDATE_LOOP_DELAY * 2;
+        delay = DEFER_SCHEDULE_UPDATE_LOOP_DELAY * 2;
 #else
-    uint32_t delay = DEFER_SCHEDULE_UPDATE_LOOP_DELAY;
+        delay = DEFER_SCHEDULE_UPDATE_LOOP_DELAY;
 #endif
+    }
 
     //ESP_LOGI(LOG_CYCLE_TAG, "Defering cycle trigger of %lu ms", delay);
     log_info_uint32(LOG_CYCLE_TAG, "Defering cycle trigger of  ", delay, " ms");
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 struct cycleManagement {
 
     unsigned int update_interval;
@@ -16,7 +18,7 @@ struct cycleManagement {
     bool hasUpdateIntervalPassed();
     bool doesCycleTimeOut();
     bool isCycleRunning();
-    void deferCycle();
+    void deferCycle(uint32_t measuredDelay = 0);
     void checkTimeout();
 
 };
\ No newline at end of file
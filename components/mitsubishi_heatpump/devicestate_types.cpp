@@ -1,6 +1,9 @@
 #include "devicestate_types.h"
 #include "floats.h"
 
+#include <cmath>
+#include <cstdint>
+
 #include "esphome.h"
 
 using namespace devicestate;
@@ -19,30 +22,69 @@ namespace devicestate {
     }
 
     bool deviceStateEqual(const DeviceState& left, const DeviceState& right) {
-        return left.active == right.active &&
-            left.mode == right.mode &&
-            left.fanMode == right.fanMode &&
-            left.swingMode == right.swingMode &&
-            left.verticalSwingMode == right.verticalSwingMode &&
-            left.horizontalSwingMode == right.horizontalSwingMode &&
-            devicestate::same_float(left.targetTemperature, right.targetTemperature, 0.01f);
+        return packDeviceState(left) == packDeviceState(right);
+    }
+
+    static const int DEVICE_STATE_MODE_SHIFT = 1;
+    static const int DEVICE_STATE_FAN_SHIFT = 4;
+    static const int DEVICE_STATE_SWING_SHIFT = 7;
+    static const int DEVICE_STATE_VERTICAL_SHIFT = 9;
+    static const int DEVICE_STATE_HORIZONTAL_SHIFT = 12;
+    static const int DEVICE_STATE_TEMPERATURE_SHIFT = 16;
+    // NaN setpoint, out of the range of any real one
+    static const int16_t DEVICE_STATE_NO_TEMPERATURE = INT16_MIN;
+
+    static_assert(DeviceMode_Unknown <= (DeviceStateField_Mode >> DEVICE_STATE_MODE_SHIFT), "DeviceMode does not fit");
+    static_assert(FanMode_High <= (DeviceStateField_FanMode >> DEVICE_STATE_FAN_SHIFT), "FanMode does not fit");
+    static_assert(SwingMode_Off <= (DeviceStateField_SwingMode >> DEVICE_STATE_SWING_SHIFT), "SwingMode does not fit");
+    static_assert(VerticalSwingMode_Off <= (DeviceStateField_VerticalSwingMode >> DEVICE_STATE_VERTICAL_SHIFT), "VerticalSwingMode does not fit");
+    static_assert(HorizontalSwingMode_Off <= (DeviceStateField_HorizontalSwingMode >> DEVICE_STATE_HORIZONTAL_SHIFT), "HorizontalSwingMode does not fit");
+
+    PackedDeviceState packDeviceState(const DeviceState& state) {
+        int16_t halfDegrees = DEVICE_STATE_NO_TEMPERATURE;
+        if (!std::isnan(state.targetTemperature)) {
+            const long rounded = std::lround(state.targetTemperature * 2.0f);
+            halfDegrees = static_cast<int16_t>(rounded < INT16_MIN + 1 ? INT16_MIN + 1 : (rounded > INT16_MAX ? INT16_MAX : rounded));
+        }
+
+        PackedDeviceState packed = state.active ? static_cast<uint32_t>(DeviceStateField_Active) : 0u;
+        packed |= (static_cast<uint32_t>(state.mode) << DEVICE_STATE_MODE_SHIFT) & DeviceStateField_Mode;
+        packed |= (static_cast<uint32_t>(state.fanMode) << DEVICE_STATE_FAN_SHIFT) & DeviceStateField_FanMode;
+        packed |= (static_cast<uint32_t>(state.swingMode) << DEVICE_STATE_SWING_SHIFT) & DeviceStateField_SwingMode;
+        packed |= (static_cast<uint32_t>(state.verticalSwingMode) << DEVICE_STATE_VERTICAL_SHIFT) & DeviceStateField_VerticalSwingMode;
+        packed |= (static_cast<uint32_t>(state.horizontalSwingMode) << DEVICE_STATE_HORIZONTAL_SHIFT) & DeviceStateField_HorizontalSwingMode;
+        packed |= static_cast<uint32_t>(static_cast<uint16_t>(halfDegrees)) << DEVICE_STATE_TEMPERATURE_SHIFT;
+        return packed;
+    }
+
+    DeviceState unpackDeviceState(PackedDeviceState packed) {
+        DeviceState state;
+        state.active = (packed & DeviceStateField_Active) != 0;
+        state.mode = static_cast<DeviceMode>((packed & DeviceStateField_Mode) >> DEVICE_STATE_MODE_SHIFT);
+        state.fanMode = static_cast<FanMode>((packed & DeviceStateField_FanMode) >> DEVICE_STATE_FAN_SHIFT);
+        state.swingMode = static_cast<SwingMode>((packed & DeviceStateField_SwingMode) >> DEVICE_STATE_SWING_SHIFT);
+        state.verticalSwingMode = static_cast<VerticalSwingMode>((packed & DeviceStateField_VerticalSwingMode) >> DEVICE_STATE_VERTICAL_SHIFT);
+        state.horizontalSwingMode = static_cast<HorizontalSwingMode>((packed & DeviceStateField_HorizontalSwingMode) >> DEVICE_STATE_HORIZONTAL_SHIFT);
+        const int16_t halfDegrees = static_cast<int16_t>(packed >> DEVICE_STATE_TEMPERATURE_SHIFT);
+        state.targetTemperature = halfDegrees == DEVICE_STATE_NO_TEMPERATURE ? NAN : halfDegrees / 2.0f;
+        return state;
     }
 
     bool isDeviceActive(heatpumpSettings& currentSettings) {
-        if (currentSettings.power == nullptr) return false;
-        return strcmp(currentSettings.power, "ON") == 0;
+        return currentSettings.power == PowerSetting_On;
     }
 
     SwingMode toSwingMode(heatpumpSettings& currentSettings) {
-        if (currentSettings.vane == nullptr || currentSettings.wideVane == nullptr) {
+        if (currentSettings.vane == VaneSetting_Unset || currentSettings.wideVane == WideVaneSetting_Unset) {
             return SwingMode::SwingMode_Off;
         }
-        if (strcmp(currentSettings.vane, "SWING") == 0 &&
-                strcmp(currentSettings.wideVane, "SWING") == 0) {
+        const bool vertical = currentSettings.vane == VaneSetting_Swing;
+        const bool horizontal = currentSettings.wideVane == WideVaneSetting_Swing;
+        if (vertical && horizontal) {
             return SwingMode::SwingMode_Both;
-        } else if (strcmp(currentSettings.vane, "SWING") == 0) {
+        } else if (vertical) {
             return SwingMode::SwingMode_Vertical;
-        } else if (strcmp(currentSettings.wideVane, "SWING") == 0) {
+        } else if (horizontal) {
             return SwingMode::SwingMode_Horizontal;
         } else {
             return SwingMode::SwingMode_Off;
@@ -50,25 +92,44 @@ namespace devicestate {
     }
 
     VerticalSwingMode toVerticalSwingMode(heatpumpSettings& currentSettings) {
-        if (currentSettings.vane == nullptr) {
-            return VerticalSwingMode::VerticalSwingMode_Off;
+        switch (currentSettings.vane) {
+            case VaneSetting_Swing:
+                return VerticalSwingMode::VerticalSwingMode_Swing;
+            case VaneSetting_Auto:
+                return VerticalSwingMode::VerticalSwingMode_Auto;
+            case VaneSetting_Up:
+                return VerticalSwingMode::VerticalSwingMode_Up;
+            case VaneSetting_UpCenter:
+                return VerticalSwingMode::VerticalSwingMode_UpCenter;
+            case VaneSetting_Center:
+                return VerticalSwingMode::VerticalSwingMode_Center;
+            case VaneSetting_DownCenter:
+                return VerticalSwingMode::VerticalSwingMode_DownCenter;
+            case VaneSetting_Down:
+                return VerticalSwingMode::VerticalSwingMode_Down;
+            default:
+                return VerticalSwingMode::VerticalSwingMode_Off;
         }
-        if (strcmp(currentSettings.vane, "SWING") == 0) {
-            return VerticalSwingMode::VerticalSwingMode_Swing;
-        } else if (strcmp(currentSettings.vane, "AUTO") == 0) {
-            return VerticalSwingMode::VerticalSwingMode_Auto;
-        } else if (strcmp(currentSettings.vane, "↑↑") == 0) {
-            return VerticalSwingMode::VerticalSwingMode_Up;
-        } else if (strcmp(currentSettings.vane, "↑") == 0) {
-            return VerticalSwingMode::VerticalSwingMode_UpCenter;
-        } else if (strcmp(currentSettings.vane, "—") == 0) {
-            return VerticalSwingMode::VerticalSwingMode_Center;
-        } else if (strcmp(currentSettings.vane, "↓") == 0) {
-            return VerticalSwingMode::VerticalSwingMode_DownCenter;
-        } else if (strcmp(currentSettings.vane, "↓↓") == 0) {
-            return VerticalSwingMode::VerticalSwingMode_Down;
-        } else {
-            return VerticalSwingMode::VerticalSwingMode_Off;
+    }
+
+    VaneSetting toVaneSetting(VerticalSwingMode mode) {
+        switch (mode) {
+            case VerticalSwingMode::VerticalSwingMode_Swing:
+                return VaneSetting_Swing;
+            case VerticalSwingMode::VerticalSwingMode_Auto:
+                return VaneSetting_Auto;
+            case VerticalSwingMode::VerticalSwingMode_Up:
+                return VaneSetting_Up;
+            case VerticalSwingMode::VerticalSwingMode_UpCenter:
+                return VaneSetting_UpCenter;
+            case VerticalSwingMode::VerticalSwingMode_Center:
+                return VaneSetting_Center;
+            case VerticalSwingMode::VerticalSwingMode_DownCenter:
+                return VaneSetting_DownCenter;
+            case VerticalSwingMode::VerticalSwingMode_Down:
+                return VaneSetting_Down;
+            default:
+                return VaneSetting_Unset;
         }
     }
 
@@ -98,25 +159,44 @@ namespace devicestate {
     }
 
     HorizontalSwingMode toHorizontalSwingMode(heatpumpSettings& currentSettings) {
-        if (currentSettings.wideVane == nullptr) {
-            return HorizontalSwingMode::HorizontalSwingMode_Off;
+        switch (currentSettings.wideVane) {
+            case WideVaneSetting_Swing:
+                return HorizontalSwingMode::HorizontalSwingMode_Swing;
+            case WideVaneSetting_LeftRight:
+                return HorizontalSwingMode::HorizontalSwingMode_Auto;
+            case WideVaneSetting_Left:
+                return HorizontalSwingMode::HorizontalSwingMode_Left;
+            case WideVaneSetting_LeftCenter:
+                return HorizontalSwingMode::HorizontalSwingMode_LeftCenter;
+            case WideVaneSetting_Center:
+                return HorizontalSwingMode::HorizontalSwingMode_Center;
+            case WideVaneSetting_RightCenter:
+                return HorizontalSwingMode::HorizontalSwingMode_RightCenter;
+            case WideVaneSetting_Right:
+                return HorizontalSwingMode::HorizontalSwingMode_Right;
+            default:
+                return HorizontalSwingMode::HorizontalSwingMode_Off;
         }
-        if (strcmp(currentSettings.wideVane, "SWING") == 0) {
-            return HorizontalSwingMode::HorizontalSwingMode_Swing;
-        } else if (strcmp(currentSettings.wideVane, "<>") == 0) {
-            return HorizontalSwingMode::HorizontalSwingMode_Auto;
-        } else if (strcmp(currentSettings.wideVane, "<<") == 0) {
-            return HorizontalSwingMode::HorizontalSwingMode_Left;
-        } else if (strcmp(currentSettings.wideVane, "<") == 0) {
-            return HorizontalSwingMode::HorizontalSwingMode_LeftCenter;
-        } else if (strcmp(currentSettings.wideVane, "|") == 0) {
-            return HorizontalSwingMode::HorizontalSwingMode_Center;
-        } else if (strcmp(currentSettings.wideVane, ">") == 0) {
-            return HorizontalSwingMode::HorizontalSwingMode_RightCenter;
-        } else if (strcmp(currentSettings.wideVane, ">>") == 0) {
-            return HorizontalSwingMode::HorizontalSwingMode_Right;
-        } else {
-            return HorizontalSwingMode::HorizontalSwingMode_Off;
+    }
+
+    WideVaneSetting toWideVaneSetting(HorizontalSwingMode mode) {
+        switch (mode) {
+            case HorizontalSwingMode::HorizontalSwingMode_Swing:
+                return WideVaneSetting_Swing;
+            case HorizontalSwingMode::HorizontalSwingMode_Auto:
+                return WideVaneSetting_LeftRight;
+            case HorizontalSwingMode::HorizontalSwingMode_Left:
+                return WideVaneSetting_Left;
+            case HorizontalSwingMode::HorizontalSwingMode_LeftCenter:
+                return WideVaneSetting_LeftCenter;
+            case HorizontalSwingMode::HorizontalSwingMode_Center:
+                return WideVaneSetting_Center;
+            case HorizontalSwingMode::HorizontalSwingMode_RightCenter:
+                return WideVaneSetting_RightCenter;
+            case HorizontalSwingMode::HorizontalSwingMode_Right:
+                return WideVaneSetting_Right;
+            default:
+                return WideVaneSetting_Unset;
         }
     }
 
@@ -143,28 +223,38 @@ namespace devicestate {
     }
 
     FanMode toFanMode(heatpumpSettings& currentSettings) {
-        /*
-        * ******* HANDLE FAN CHANGES ********
-        *
-        * const char* FAN_MAP[6]         = {"AUTO", "QUIET", "1", "2", "3", "4"};
-        */
-        if (currentSettings.fan == nullptr) {
-            return FanMode::FanMode_Auto;
+        switch (currentSettings.fan) {
+            case FanSetting_Quiet:
+                return FanMode::FanMode_Quiet;
+            case FanSetting_Speed1:
+                return FanMode::FanMode_Low;
+            case FanSetting_Speed2:
+                return FanMode::FanMode_Medium;
+            case FanSetting_Speed3:
+                return FanMode::FanMode_Middle;
+            case FanSetting_Speed4:
+                return FanMode::FanMode_High;
+            default: // FanSetting_Auto or unset
+                return FanMode::FanMode_Auto;
         }
-        if (strcmp(currentSettings.fan, "AUTO") == 0) {
-            return FanMode::FanMode_Auto;
-        } else if (strcmp(currentSettings.fan, "QUIET") == 0) {
-            return FanMode::FanMode_Quiet;
-        } else if (strcmp(currentSettings.fan, "1") == 0) {
-            return FanMode::FanMode_Low;
-        } else if (strcmp(currentSettings.fan, "2") == 0) {
-            return FanMode::FanMode_Medium;
-        } else if (strcmp(currentSettings.fan, "3") == 0) {
-            return FanMode::FanMode_Middle;
-        } else if (strcmp(currentSettings.fan, "4") == 0) {
-            return FanMode::FanMode_High;
-        } else { //case "AUTO" or default:
-            return FanMode::FanMode_Auto;
+    }
+
+    FanSetting toFanSetting(FanMode mode) {
+        switch (mode) {
+            case FanMode::FanMode_Auto:
+                return FanSetting_Auto;
+            case FanMode::FanMode_Quiet:
+                return FanSetting_Quiet;
+            case FanMode::FanMode_Low:
+                return FanSetting_Speed1;
+            case FanMode::FanMode_Medium:
+                return FanSetting_Speed2;
+            case FanMode::FanMode_Middle:
+                return FanSetting_Speed3;
+            case FanMode::FanMode_High:
+                return FanSetting_Speed4;
+            default:
+                return FanSetting_Unset;
         }
     }
 
@@ -205,22 +295,39 @@ namespace devicestate {
     }
 
     DeviceMode toDeviceMode(heatpumpSettings& currentSettings) {
-        if (currentSettings.mode == nullptr) {
-            return DeviceMode::DeviceMode_Fan;
+        switch (currentSettings.mode) {
+            case ModeSetting_Heat:
+                return DeviceMode::DeviceMode_Heat;
+            case ModeSetting_Dry:
+                return DeviceMode::DeviceMode_Dry;
+            case ModeSetting_Cool:
+                return DeviceMode::DeviceMode_Cool;
+            case ModeSetting_Fan:
+            case ModeSetting_Unset:
+                return DeviceMode::DeviceMode_Fan;
+            case ModeSetting_Auto:
+                return DeviceMode::DeviceMode_Auto;
+            default:
+                ESP_LOGW(TAG, "Invalid device mode %d", currentSettings.mode);
+                return DeviceMode::DeviceMode_Fan;
         }
-        if (strcmp(currentSettings.mode, "HEAT") == 0) {
-            return DeviceMode::DeviceMode_Heat;
-        } else if (strcmp(currentSettings.mode, "DRY") == 0) {
-            return DeviceMode::DeviceMode_Dry;
-        } else if (strcmp(currentSettings.mode, "COOL") == 0) {
-            return DeviceMode::DeviceMode_Cool;
-        } else if (strcmp(currentSettings.mode, "FAN") == 0) {
-            return DeviceMode::DeviceMode_Fan;
-        } else if (strcmp(currentSettings.mode, "AUTO") == 0) {
-            return DeviceMode::DeviceMode_Auto;
-        } else {
-            ESP_LOGW(TAG, "Invalid device mode %s", currentSettings.mode);
-            return DeviceMode::DeviceMode_Fan;
+    }
+
+    ModeSetting toModeSetting(DeviceMode mode) {
+        switch (mode) {
+            case DeviceMode::DeviceMode_Heat:
+                return ModeSetting_Heat;
+            case DeviceMode::DeviceMode_Cool:
+                return ModeSetting_Cool;
+            case DeviceMode::DeviceMode_Dry:
+                return ModeSetting_Dry;
+            case DeviceMode::DeviceMode_Fan:
+                return ModeSetting_Fan;
+            case DeviceMode::DeviceMode_Auto:
+                return ModeSetting_Auto;
+            default:
+                ESP_LOGW(TAG, "Invalid device mode %d", mode);
+                return ModeSetting_Auto;
         }
     }
 
@@ -15,6 +15,7 @@ namespace devicestate {
     DeviceMode_Unknown
   };
   DeviceMode toDeviceMode(heatpumpSettings& currentSettings);
+  ModeSetting toModeSetting(DeviceMode mode);
   const char* deviceModeToString(DeviceMode mode);
 
   enum FanMode {
@@ -26,6 +27,7 @@ namespace devicestate {
     FanMode_High
   };
   FanMode toFanMode(heatpumpSettings& currentSettings);
+  FanSetting toFanSetting(FanMode mode);
   const char* fanModeToString(FanMode mode);
 
   enum SwingMode {
@@ -48,6 +50,7 @@ namespace devicestate {
     VerticalSwingMode_Off
   };
   VerticalSwingMode toVerticalSwingMode(heatpumpSettings& currentSettings);
+  VaneSetting toVaneSetting(VerticalSwingMode mode);
   const char* verticalSwingModeToString(VerticalSwingMode mode);
 
   enum HorizontalSwingMode {
@@ -61,8 +64,25 @@ namespace devicestate {
     HorizontalSwingMode_Off
   };
   HorizontalSwingMode toHorizontalSwingMode(heatpumpSettings& currentSettings);
+  WideVaneSetting toWideVaneSetting(HorizontalSwingMode mode);
   const char* horizontalSwingModeToString(HorizontalSwingMode mode);
 
+  // sensors published by DeviceStateManager::publish()
+  enum PublishedSensor {
+    PublishedSensor_InternalPowerOn,
+    PublishedSensor_Active,
+    PublishedSensor_SetPoint,
+    PublishedSensor_Operating,
+    PublishedSensor_CurrentTemperature,
+    PublishedSensor_OutsideTemperature,
+    PublishedSensor_CompressorFrequency,
+    PublishedSensor_InputPower,
+    PublishedSensor_KWh,
+    PublishedSensor_RuntimeHours,
+    PublishedSensor_PidSetPointCorrection,
+    PublishedSensor_Count
+  };
+
   struct DeviceStatus {
     bool operating;
     float currentTemperature;
@@ -89,6 +109,33 @@ namespace devicestate {
   bool deviceStateEqual(const DeviceState& left, const DeviceState& right);
   DeviceState toDeviceState(heatpumpSettings& currentSettings);
 
+  /**
+   * Canonical DeviceState in one word: snapshots are a copy and change
+   * detection a compare. XOR of two words, masked with DeviceStateField_*,
+   * tells which fields changed. The setpoint is kept in half degrees, the
+   * resolution of the heatpump.
+   */
+  typedef uint32_t PackedDeviceState;
+
+  enum DeviceStateField : uint32_t {
+    DeviceStateField_Active              = 0x00000001,
+    DeviceStateField_Mode                = 0x0000000E,
+    DeviceStateField_FanMode             = 0x00000070,
+    DeviceStateField_SwingMode           = 0x00000180,
+    DeviceStateField_VerticalSwingMode   = 0x00000E00,
+    DeviceStateField_HorizontalSwingMode = 0x00007000,
+    DeviceStateField_TargetTemperature   = 0xFFFF0000,
+    DeviceStateField_All                 = 0xFFFF7FFF
+  };
+
+  PackedDeviceState packDeviceState(const DeviceState& state);
+  DeviceState unpackDeviceState(PackedDeviceState packed);
+
+  // fields that differ between two snapshots, test with DeviceStateField_* masks
+  inline uint32_t deviceStateDiff(PackedDeviceState before, PackedDeviceState after) {
+    return before ^ after;
+  }
+
   void log_device_state(const DeviceState& state);
 
   class IDeviceStateManager {
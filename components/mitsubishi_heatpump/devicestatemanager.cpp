@@ -1,6 +1,6 @@
 #include "devicestatemanager.h"
 
-#include "espmhp.h"
+#include "Globals.h"
 using namespace esphome;
 
 #include "floats.h"
@@ -14,6 +14,22 @@ namespace devicestate {
 
     static const char* TAG = "DeviceStateManager"; // Logging tag
 
+    // default deadbands, in the order of PublishedSensor: the temperatures and the frequency
+    // already come quantized, power and energy jitter in their last digit
+    static const float DEFAULT_PUBLISH_DEADBANDS[PublishedSensor_Count] = {
+        0,      // internal power on
+        0,      // active
+        0,      // set point
+        0,      // operating
+        0,      // current temperature
+        0,      // outside temperature
+        0,      // compressor frequency
+        10.0f,  // input power (W)
+        0.1f,   // energy (kWh)
+        0,      // runtime hours
+        0.1f    // PID set point correction
+    };
+
     DeviceStateManager::DeviceStateManager(
       IIODevice* io_device,
       CN105State* hpState,
@@ -48,6 +64,8 @@ namespace devicestate {
         this->device_status_runtime_hours = device_status_runtime_hours;
         this->pid_set_point_correction = pid_set_point_correction;
 
+        memcpy(this->publishDeadband, DEFAULT_PUBLISH_DEADBANDS, sizeof(this->publishDeadband));
+
         ESP_LOGCONFIG(TAG, "Initializing new HeatPump object.");
     }
 
@@ -61,17 +79,19 @@ namespace devicestate {
         this->log_heatpump_settings(currentSettings);
 
         const DeviceState deviceState = devicestate::toDeviceState(currentSettings);
+        const PackedDeviceState deviceStateWord = devicestate::packDeviceState(deviceState);
         if (!this->settingsInitialized) {
             ESP_LOGW(TAG, "Initializing internalPowerOn state to %s", ONOFF(deviceState.active));
             ESP_LOGW(TAG, "Initializing targetTemperature state from %f to %f", this->targetTemperature, deviceState.targetTemperature);
             this->internalPowerOn = deviceState.active;
             this->targetTemperature = deviceState.targetTemperature;
             this->deviceState = deviceState;
+            this->deviceStateWord = deviceStateWord;
             this->settingsInitialized = true;
             return;
         }
 
-        if (deviceStateEqual(this->deviceState, deviceState)) {
+        if (deviceStateWord == this->deviceStateWord) {
             return;
         }
 
@@ -80,6 +100,7 @@ namespace devicestate {
         }
 
         this->deviceState = deviceState;
+        this->deviceStateWord = deviceStateWord;
         ESP_LOGW(TAG, "Callback hpStatusChanged");
     }
 
@@ -126,6 +147,10 @@ namespace devicestate {
         return this->deviceState;
     }
 
+    PackedDeviceState DeviceStateManager::getPackedDeviceState() {
+        return this->deviceStateWord;
+    }
+
     void DeviceStateManager::update() {
         //ESP_LOGE(TAG, "Updating...");
         //log_device_state(this->deviceState);
@@ -165,15 +190,13 @@ namespace devicestate {
     }
 
     void DeviceStateManager::turnOn(DeviceMode mode) {
-        const char* deviceMode = deviceModeToString(mode);
-
-        this->hpState->setModeSetting(deviceMode);
-        this->hpState->setPowerSetting("ON");
+        this->hpState->setModeSetting(toModeSetting(mode));
+        this->hpState->setPowerSetting(true);
         this->internalPowerOn = true;
     }
 
     void DeviceStateManager::turnOff() {
-        this->hpState->setPowerSetting("OFF");
+        this->hpState->setPowerSetting(false);
         this->internalPowerOn = false;
     }
 
@@ -196,9 +219,8 @@ namespace devicestate {
             return false;
         }
 
-        const char* deviceMode = deviceModeToString(this->deviceState.mode);
-        this->hpState->setModeSetting(deviceMode);
-        this->hpState->setPowerSetting("ON");
+        this->hpState->setModeSetting(toModeSetting(this->deviceState.mode));
+        this->hpState->setPowerSetting(true);
         this->internalSetCorrectedTemperature(this->getTargetTemperature());
         this->commit();
         this->lastInternalPowerUpdate = end;
@@ -221,7 +243,7 @@ namespace devicestate {
         }
 
         ESP_LOGW(TAG, "Set power OFF");
-        this->hpState->setPowerSetting("OFF");
+        this->hpState->setPowerSetting(false);
         ESP_LOGW(TAG, "Commit change");
         this->commit();
         this->lastInternalPowerUpdate = end;
@@ -237,12 +259,13 @@ namespace devicestate {
             return false;
         }
 
-        if (strcmp(newMode,"UNKNOWN") == 0) {
+        const FanSetting setting = toFanSetting(mode);
+        if (setting == FanSetting_Unset) {
             ESP_LOGW(TAG, "Did not update fan mode due to invalid value: %s", newMode);
             return false;
         }
 
-        this->hpState->setFanSpeed(newMode);
+        this->hpState->setFanSpeed(setting);
         this->commit();
         return true;
     }
@@ -255,12 +278,13 @@ namespace devicestate {
             return false;
         }
 
-        if (strcmp(newMode,"UNKNOWN") == 0) {
+        const VaneSetting setting = toVaneSetting(mode);
+        if (setting == VaneSetting_Unset) {
             ESP_LOGW(TAG, "Did not update vertical swing mode due to invalid value: %s", newMode);
             return false;
         }
 
-        this->hpState->setVaneSetting(newMode);
+        this->hpState->setVaneSetting(setting);
         this->commit();
         return true;
     }
@@ -273,12 +297,13 @@ namespace devicestate {
             return false;
         }
 
-        if (strcmp(newMode,"UNKNOWN") == 0) {
+        const WideVaneSetting setting = toWideVaneSetting(mode);
+        if (setting == WideVaneSetting_Unset) {
             ESP_LOGW(TAG, "Did not update horizontal swing mode due to invalid value: %s", newMode);
             return false;
         }
 
-        this->hpState->setWideVaneSetting(newMode);
+        this->hpState->setWideVaneSetting(setting);
         this->commit();
         return true;
     }
@@ -323,7 +348,6 @@ namespace devicestate {
 
     bool DeviceStateManager::internalSetCorrectedTemperature(const float setPointCorrection) {
         const DeviceState deviceState = this->getDeviceState();
-        const bool direction = this->getOffsetDirection(deviceState);
 
         const float adjustedCorrectedTemperature = devicestate::clamp(setPointCorrection, this->minTemp, this->maxTemp);
         const float roundedAdjustedCorrectedTemperature = this->getRoundedTemp(adjustedCorrectedTemperature);
@@ -351,12 +375,12 @@ namespace devicestate {
     }
 
     void DeviceStateManager::log_heatpump_settings(heatpumpSettings& currentSettings) {
-        ESP_LOGD(TAG, "  power: %s", SAFE_STR(currentSettings.power));
-        ESP_LOGD(TAG, "  mode: %s", SAFE_STR(currentSettings.mode));
+        ESP_LOGD(TAG, "  power: %s", SAFE_STR(powerSettingToString(currentSettings.power)));
+        ESP_LOGD(TAG, "  mode: %s", SAFE_STR(modeSettingToString(currentSettings.mode)));
         ESP_LOGD(TAG, "  temperature: %f", currentSettings.temperature);
-        ESP_LOGD(TAG, "  fan: %s", SAFE_STR(currentSettings.fan));
-        ESP_LOGD(TAG, "  vane: %s", SAFE_STR(currentSettings.vane));
-        ESP_LOGD(TAG, "  wideVane: %s", SAFE_STR(currentSettings.wideVane));
+        ESP_LOGD(TAG, "  fan: %s", SAFE_STR(fanSettingToString(currentSettings.fan)));
+        ESP_LOGD(TAG, "  vane: %s", SAFE_STR(vaneSettingToString(currentSettings.vane)));
+        ESP_LOGD(TAG, "  wideVane: %s", SAFE_STR(wideVaneSettingToString(currentSettings.wideVane)));
         ESP_LOGD(TAG, "  connected: %s", TRUEFALSE(currentSettings.connected));
     }
 
@@ -389,47 +413,107 @@ namespace devicestate {
         this->log_heatpump_settings(currentSettings);
     }
 
-    void DeviceStateManager::publish() {
-        if (!this->isInitialized()) {
-            ESP_LOGD(TAG, "Skipping state publication until settings and status are initialized.");
-            return;
+    void DeviceStateManager::setPublishDeadband(PublishedSensor sensor, float deadband) {
+        if (sensor < PublishedSensor_Count) {
+            this->publishDeadband[sensor] = deadband > 0 ? deadband : 0;
         }
+    }
 
-        // Publish device status (with null checks)
-        if (this->device_status_operating) {
-            this->device_status_operating->publish_state(this->deviceStatus.operating);
-        }
-        if (this->device_status_current_temperature) {
-            this->device_status_current_temperature->publish_state(this->deviceStatus.currentTemperature);
-        }
-        if (this->device_status_outside_temperature) {
-            this->device_status_outside_temperature->publish_state(this->deviceStatus.outsideTemperature);
-        }
-        if (this->device_status_compressor_frequency) {
-            this->device_status_compressor_frequency->publish_state(this->deviceStatus.compressorFrequency);
-        }
-        if (this->device_status_input_power) {
-            this->device_status_input_power->publish_state(this->deviceStatus.inputPower);
-        }
-        if (this->device_status_kwh) {
-            this->device_status_kwh->publish_state(this->deviceStatus.kWh);
+    void DeviceStateManager::setPublishHeartbeat(uint32_t heartbeat_ms) {
+        this->publishHeartbeatMs = heartbeat_ms;
+    }
+
+    bool DeviceStateManager::shouldPublish(PublishedSensor sensor, float value, uint32_t now) {
+        PublishedValue& last = this->published[sensor];
+        bool changed;
+        if (!last.published) {
+            changed = true;
+        } else if (std::isnan(value) || std::isnan(last.value)) {
+            changed = std::isnan(value) != std::isnan(last.value);
+        } else {
+            const float delta = std::fabs(value - last.value);
+            changed = this->publishDeadband[sensor] > 0 ? delta >= this->publishDeadband[sensor] : delta > 0;
         }
-        if (this->device_status_runtime_hours) {
-            this->device_status_runtime_hours->publish_state(this->deviceStatus.runtimeHours);
+        if (!changed && (this->publishHeartbeatMs == 0 || now - last.lastMs < this->publishHeartbeatMs)) {
+            return false;
         }
+        last.value = value;
+        last.lastMs = now;
+        last.published = true;
+        return true;
+    }
 
-        // Publish device state (with null checks)
-        if (this->internal_power_on) {
-            this->internal_power_on->publish_state(this->internalPowerOn);
-        }
-        if (this->device_state_active) {
-            this->device_state_active->publish_state(this->deviceState.active);
+    void DeviceStateManager::publish() {
+        if (!this->isInitialized()) {
+            ESP_LOGD(TAG, "Skipping state publication until settings and status are initialized.");
+            return;
         }
-        if (this->device_set_point) {
-            this->device_set_point->publish_state(this->deviceState.targetTemperature);
+        const uint32_t now = esphome::millis();
+        for (uint8_t i = 0; i < PublishedSensor_Count; i++) {
+            this->publishSensor(static_cast<PublishedSensor>(i), now);
         }
-        if (this->pid_set_point_correction) {
-            this->pid_set_point_correction->publish_state(this->correctedTargetTemperature);
+    }
+
+    void DeviceStateManager::publishSensor(PublishedSensor sensor, uint32_t now) {
+        // null checks: every sensor is optional
+        switch (sensor) {
+        case PublishedSensor_InternalPowerOn:
+            if (this->internal_power_on && this->shouldPublish(sensor, this->internalPowerOn, now)) {
+                this->internal_power_on->publish_state(this->internalPowerOn);
+            }
+            break;
+        case PublishedSensor_Active:
+            if (this->device_state_active && this->shouldPublish(sensor, this->deviceState.active, now)) {
+                this->device_state_active->publish_state(this->deviceState.active);
+            }
+            break;
+        case PublishedSensor_SetPoint:
+            if (this->device_set_point && this->shouldPublish(sensor, this->deviceState.targetTemperature, now)) {
+                this->device_set_point->publish_state(this->deviceState.targetTemperature);
+            }
+            break;
+        case PublishedSensor_Operating:
+            if (this->device_status_operating && this->shouldPublish(sensor, this->deviceStatus.operating, now)) {
+                this->device_status_operating->publish_state(this->deviceStatus.operating);
+            }
+            break;
+        case PublishedSensor_CurrentTemperature:
+            if (this->device_status_current_temperature && this->shouldPublish(sensor, this->deviceStatus.currentTemperature, now)) {
+                this->device_status_current_temperature->publish_state(this->deviceStatus.currentTemperature);
+            }
+            break;
+        case PublishedSensor_OutsideTemperature:
+            if (this->device_status_outside_temperature && this->shouldPublish(sensor, this->deviceStatus.outsideTemperature, now)) {
+                this->device_status_outside_temperature->publish_state(this->deviceStatus.outsideTemperature);
+            }
+            break;
+        case PublishedSensor_CompressorFrequency:
+            if (this->device_status_compressor_frequency && this->shouldPublish(sensor, this->deviceStatus.compressorFrequency, now)) {
+                this->device_status_compressor_frequency->publish_state(this->deviceStatus.compressorFrequency);
+            }
+            break;
+        case PublishedSensor_InputPower:
+            if (this->device_status_input_power && this->shouldPublish(sensor, this->deviceStatus.inputPower, now)) {
+                this->device_status_input_power->publish_state(this->deviceStatus.inputPower);
+            }
+            break;
+        case PublishedSensor_KWh:
+            if (this->device_status_kwh && this->shouldPublish(sensor, this->deviceStatus.kWh, now)) {
+                this->device_status_kwh->publish_state(this->deviceStatus.kWh);
+            }
+            break;
+        case PublishedSensor_RuntimeHours:
+            if (this->device_status_runtime_hours && this->shouldPublish(sensor, this->deviceStatus.runtimeHours, now)) {
+                this->device_status_runtime_hours->publish_state(this->deviceStatus.runtimeHours);
+            }
+            break;
+        case PublishedSensor_PidSetPointCorrection:
+            if (this->pid_set_point_correction && this->shouldPublish(sensor, this->correctedTargetTemperature, now)) {
+                this->pid_set_point_correction->publish_state(this->correctedTargetTemperature);
+            }
+            break;
+        default:
+            break;
         }
     }
 
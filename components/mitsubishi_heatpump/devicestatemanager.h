@@ -47,10 +47,23 @@ namespace devicestate {
 
       bool settingsInitialized = false;
       DeviceState deviceState{};
+      PackedDeviceState deviceStateWord{0};
 
       bool statusInitialized = false;
       DeviceStatus deviceStatus{};
 
+      // last value sent to each sensor, published again only past its deadband or the heartbeat
+      struct PublishedValue {
+        float value;
+        uint32_t lastMs;
+        bool published;
+      };
+      PublishedValue published[PublishedSensor_Count]{};
+      float publishDeadband[PublishedSensor_Count];
+      uint32_t publishHeartbeatMs = PUBLISH_HEARTBEAT_DEFAULT_MS;
+
+      bool shouldPublish(PublishedSensor sensor, float value, uint32_t now);
+
       void hpSettingsChanged();
       void hpStatusChanged();
 
@@ -86,6 +99,8 @@ namespace devicestate {
 
       DeviceStatus getDeviceStatus();
       DeviceState getDeviceState();
+      // same state packed in one word, see packDeviceState()
+      PackedDeviceState getPackedDeviceState();
 
       bool isInitialized();
 
@@ -119,7 +134,13 @@ namespace devicestate {
 
       bool getOffsetDirection() override;
 
+      // smallest change of a sensor worth publishing, 0: any change
+      void setPublishDeadband(PublishedSensor sensor, float deadband);
+      // unchanged sensors are published again every heartbeat_ms, 0: never
+      void setPublishHeartbeat(uint32_t heartbeat_ms);
       void publish();
+      // one sensor of publish(), for callers spreading the publication over several loops
+      void publishSensor(PublishedSensor sensor, uint32_t now);
   };
 }
 #endif
@@ -77,22 +77,61 @@ void MitsubishiHeatPump::set_debounce_delay(uint32_t delay) {
 
 void MitsubishiHeatPump::terminateCycle() {
     ESP_LOGD(TAG, "Terminate cycle start");
-    this->hpControlFlow_->completeCycle();
 
-    this->dsm->update();
-    if (this->dsm->isInitialized()) {
-        this->updateDevice();
-
-        this->run_workflows();
-        this->dsm->publish();
-    } else {
-        ESP_LOGW(TAG, "DeviceStateManager not yet initialized.");
-    }
+    // the publication runs from loop(), spread over as many iterations as the budget needs
+    this->queue_publish(PublishTask_Update | PublishTask_Device | PublishTask_Workflows | PublishTask_Sensors | PublishTask_Latency);
 
     this->loopCycle.cycleEnded();
     ESP_LOGD(TAG, "Terminate cycle complete");
 }
 
+void MitsubishiHeatPump::queue_publish(uint8_t tasks) {
+    if (tasks & PublishTask_Sensors) {
+        // queued again: every sensor is looked at with the new state
+        this->publish_sensor_ = 0;
+    }
+    this->pending_publish_ |= tasks;
+}
+
+void MitsubishiHeatPump::run_publish_tasks() {
+    if (this->pending_publish_ == 0) {
+        return;
+    }
+    // at least one step per loop, more while the budget lasts; a step is not split,
+    // so the loop exceeds the budget by at most the length of the last one
+    const uint32_t start = esphome::micros();
+    do {
+        this->run_publish_step();
+    } while (this->pending_publish_ != 0 &&
+        (this->publish_budget_ == 0 || esphome::micros() - start < this->publish_budget_));
+}
+
+void MitsubishiHeatPump::run_publish_step() {
+    // tasks run in the order of their bits
+    if (this->pending_publish_ & PublishTask_Update) {
+        this->pending_publish_ &= ~PublishTask_Update;
+        this->dsm->update();
+        if (!this->dsm->isInitialized()) {
+            ESP_LOGW(TAG, "DeviceStateManager not yet initialized.");
+            this->pending_publish_ &= ~(PublishTask_Device | PublishTask_Workflows | PublishTask_Sensors);
+        }
+    } else if (this->pending_publish_ & PublishTask_Device) {
+        this->pending_publish_ &= ~PublishTask_Device;
+        this->updateDevice();
+    } else if (this->pending_publish_ & PublishTask_Workflows) {
+        this->pending_publish_ &= ~PublishTask_Workflows;
+        this->run_workflows();
+    } else if (this->pending_publish_ & PublishTask_Sensors) {
+        this->dsm->publishSensor(static_cast<devicestate::PublishedSensor>(this->publish_sensor_), esphome::millis());
+        if (++this->publish_sensor_ >= devicestate::PublishedSensor_Count) {
+            this->pending_publish_ &= ~PublishTask_Sensors;
+        }
+    } else if (this->pending_publish_ & PublishTask_Latency) {
+        this->pending_publish_ &= ~PublishTask_Latency;
+        this->publish_latency();
+    }
+}
+
 void MitsubishiHeatPump::banner() {
     ESP_LOGI(TAG, "ESPHome MitsubishiHeatPump version %s", ESPMHP_VERSION);
 }
@@ -103,6 +142,7 @@ void MitsubishiHeatPump::banner() {
  */
 void MitsubishiHeatPump::loop() {
     this->hpControlFlow_->loop(loopCycle);
+    this->run_publish_tasks();
 }
 
 /**
@@ -406,30 +446,29 @@ void MitsubishiHeatPump::on_horizontal_swing_change(const std::string &swing) {
  * Maps HomeAssistant/ESPHome modes to Mitsubishi modes.
  */
 void MitsubishiHeatPump::control(const climate::ClimateCall &call) {
-    // Capture `call` by value: on non-ESP32 acquireWantedSettingsLock defers the
-    // callback (set_timeout 0) to a later loop, by which point a reference to the
-    // caller's ClimateCall would dangle. ClimateCall is copyable, so copy it.
-    auto callback = [this, call]() {
+    // applied right away, as one update the bus path either sees whole or not yet
+    this->hpControlFlow_->updateWantedSettings([this, &call]() {
         this->controlDelegate(call);
-    };
-
-    this->hpControlFlow_->acquireWantedSettingsLock(callback);
+    });
 }
 
 void MitsubishiHeatPump::updateDevice() {
-    const DeviceState deviceState = this->dsm->getDeviceState();
+    const devicestate::PackedDeviceState deviceStateWord = this->dsm->getPackedDeviceState();
     const DeviceStatus deviceStatus = this->dsm->getDeviceStatus();
     if (this->hasLastDeviceSnapshot &&
-            devicestate::deviceStateEqual(this->lastDeviceState, deviceState) &&
+            deviceStateWord == this->lastDeviceState &&
             devicestate::deviceStatusEqual(this->lastDeviceStatus, deviceStatus) &&
             !this->remote_temperature_updated) {
         ESP_LOGD(TAG, "Skipping updateDevice due to no change");
         return;
     }
 
-    ESP_LOGI(TAG, "Running updateDevice...");
+    const uint32_t changed = this->hasLastDeviceSnapshot ?
+        devicestate::deviceStateDiff(this->lastDeviceState, deviceStateWord) : devicestate::DeviceStateField_All;
+    ESP_LOGI(TAG, "Running updateDevice (changed fields 0x%08X)...", static_cast<unsigned int>(changed));
+    const DeviceState deviceState = this->dsm->getDeviceState();
     this->remote_temperature_updated = false;
-    this->lastDeviceState = deviceState;
+    this->lastDeviceState = deviceStateWord;
     this->lastDeviceStatus = deviceStatus;
     this->hasLastDeviceSnapshot = true;
 
@@ -595,6 +634,8 @@ void MitsubishiHeatPump::updateDevice() {
     }
     ESP_LOGD(TAG, "Swing mode is: %d", this->swing_mode);
 
+    // the selects are always put back to the real vane position (a rejected choice is undone),
+    // update_swing_* only publish when it differs; the log line follows the field changes
     switch(deviceState.verticalSwingMode) {
         case VerticalSwingMode::VerticalSwingMode_Swing:
             this->update_swing_vertical("swing");
@@ -620,7 +661,9 @@ void MitsubishiHeatPump::updateDevice() {
         default:
             break;
     }
-    ESP_LOGD(TAG, "Vertical vane mode is: %s", verticalSwingModeToString(deviceState.verticalSwingMode));
+    if (changed & devicestate::DeviceStateField_VerticalSwingMode) {
+        ESP_LOGD(TAG, "Vertical vane mode is: %s", verticalSwingModeToString(deviceState.verticalSwingMode));
+    }
 
     switch(deviceState.horizontalSwingMode) {
         case HorizontalSwingMode::HorizontalSwingMode_Swing:
@@ -647,7 +690,9 @@ void MitsubishiHeatPump::updateDevice() {
         default:
             break;
     }
-    ESP_LOGD(TAG, "Horizontal vane mode is: %s", horizontalSwingModeToString(deviceState.horizontalSwingMode));
+    if (changed & devicestate::DeviceStateField_HorizontalSwingMode) {
+        ESP_LOGD(TAG, "Horizontal vane mode is: %s", horizontalSwingModeToString(deviceState.horizontalSwingMode));
+    }
 
     this->target_temperature = this->dsm->getTargetTemperature();
 
@@ -662,8 +707,18 @@ void MitsubishiHeatPump::set_remote_temperature(float temp) {
     if (temp > 0) {
         last_remote_temperature_sensor_update_ = 
             std::chrono::steady_clock::now();
+
+        float filtered;
+        if (!this->remote_temp_filter_.push(temp, filtered)) {
+            // absorbed by the filter: nothing to send or publish, but the sensor is alive
+            ESP_LOGV(TAG, "Remote temp %.2f filtered out", temp);
+            this->hpControlFlow_->pingExternalTemperature();
+            return;
+        }
+        temp = filtered;
     } else {
         last_remote_temperature_sensor_update_.reset();
+        this->remote_temp_filter_.reset();
     }
 
     this->remote_temperature_updated =
@@ -745,37 +800,9 @@ void MitsubishiHeatPump::setup() {
         return;
     }
 
-    auto timeoutCallback = [this](const std::string& name, uint32_t timeout_ms, std::function<void()> callback) {
-        this->set_timeout(name.c_str(), timeout_ms, std::move(callback));
-    };
-
-    auto retryCallback = [this](const std::string& name, uint32_t initial_wait_time, uint8_t max_attempts, std::function<esphome::RetryResult(uint8_t)> callback) {
-        // set_retry was deprecated in ESPHome 2026.2.0 (removed in 2026.8.0).
-        // Reimplement its semantics with chained set_timeout + 1.2x exponential
-        // backoff (see esphome blog 2026/02/12): the first attempt runs
-        // immediately, the callback receives the remaining attempt countdown,
-        // and we stop on RetryResult::DONE or when the countdown reaches 0.
-        struct RetryState {
-            std::function<esphome::RetryResult(uint8_t)> func;
-            uint8_t countdown;
-            uint32_t interval;
-        };
-        auto state = std::make_shared<RetryState>(
-            RetryState{std::move(callback), max_attempts, initial_wait_time});
-        auto handler = std::make_shared<std::function<void()>>();
-        *handler = [this, name, state, handler]() {
-            if (state->countdown == 0) {
-                return;
-            }
-            esphome::RetryResult result = state->func(--state->countdown);
-            if (result == esphome::RetryResult::DONE || state->countdown == 0) {
-                return;
-            }
-            this->set_timeout(name.c_str(), state->interval, [handler]() { (*handler)(); });
-            state->interval = static_cast<uint32_t>(state->interval * 1.2f);
-        };
-        // First execution immediately, matching the old set_retry behavior.
-        this->set_timeout(name.c_str(), 0, [handler]() { (*handler)(); });
+    // timeout names are string literals or live in the request scheduler: no copy needed
+    auto timeoutCallback = [this](const char* name, uint32_t timeout_ms, std::function<void()> callback) {
+        this->set_timeout(name, timeout_ms, std::move(callback));
     };
 
     auto terminateCallback = [this]() {
@@ -810,13 +837,13 @@ void MitsubishiHeatPump::setup() {
         this->mark_failed();
         return;
     }
+    hpConnection->setPacingBounds(this->min_frame_interval_, this->max_frame_interval_);
 
     this->hpControlFlow_ = new (std::nothrow) CN105ControlFlow(
         hpConnection,
         this->hpState_,
         timeoutCallback,
         terminateCallback,
-        retryCallback,
         this->debounce_delay_,
         this->remote_temp_timeout_
     );
@@ -825,6 +852,13 @@ void MitsubishiHeatPump::setup() {
         this->mark_failed();
         return;
     }
+    this->hpControlFlow_->set_adaptive_polling(this->min_poll_interval_, this->max_poll_interval_);
+    this->hpControlFlow_->set_remote_temp_fast_path(this->remote_temp_fast_delta_, this->remote_temp_fast_interval_);
+    this->hpControlFlow_->set_remote_temp_dithering(this->remote_temp_dither_interval_);
+    // a confirmed write is published right away instead of at the end of the next cycle
+    this->hpControlFlow_->set_write_confirm_callback([this](bool) {
+        this->queue_publish(PublishTask_Update | PublishTask_Device | PublishTask_Sensors);
+    });
 
     this->hpState_->getWantedSettings().resetSettings();
     this->hpState_->getWantedSettings().resetSettings();
@@ -852,6 +886,12 @@ void MitsubishiHeatPump::setup() {
         this->mark_failed();
         return;
     }
+    this->dsm->setPublishHeartbeat(this->publish_heartbeat_);
+    for (uint8_t i = 0; i < devicestate::PublishedSensor_Count; i++) {
+        if (!std::isnan(this->publish_deadbands_[i])) {
+            this->dsm->setPublishDeadband(static_cast<devicestate::PublishedSensor>(i), this->publish_deadbands_[i]);
+        }
+    }
 
     // create various setpoint persistence:
     cool_storage = global_preferences->make_preference<uint8_t>(this->get_object_id_hash() + 1);
@@ -909,6 +949,65 @@ void MitsubishiHeatPump::dump_config() {
     ESP_LOGI(TAG, "  Saved cool: %.1f", cool_setpoint.value_or(-1));
     ESP_LOGI(TAG, "  Saved auto: %.1f", auto_setpoint.value_or(-1));
     ESP_LOGI(TAG, "  Update interval: %d", this->get_update_interval());
+    ESP_LOGI(TAG, "  Frame interval: %u..%u ms", static_cast<unsigned int>(this->min_frame_interval_), static_cast<unsigned int>(this->max_frame_interval_));
+    if (this->max_poll_interval_ > 0) {
+        ESP_LOGI(TAG, "  Adaptive polling: %u..%u ms", static_cast<unsigned int>(this->min_poll_interval_), static_cast<unsigned int>(this->max_poll_interval_));
+    }
+    if (this->remote_temp_fast_delta_ > 0) {
+        ESP_LOGI(TAG, "  Remote temperature fast path: %.1f °C, every %u ms at most", this->remote_temp_fast_delta_,
+            static_cast<unsigned int>(this->remote_temp_fast_interval_));
+    }
+    if (this->remote_temp_dither_interval_ > 0) {
+        ESP_LOGI(TAG, "  Remote temperature dithering: every %u ms", static_cast<unsigned int>(this->remote_temp_dither_interval_));
+    }
+    ESP_LOGI(TAG, "  Publish budget: %u us per loop", static_cast<unsigned int>(this->publish_budget_));
+    if (this->publish_heartbeat_ > 0) {
+        ESP_LOGI(TAG, "  Publish heartbeat: %u ms", static_cast<unsigned int>(this->publish_heartbeat_));
+    }
+    if (this->remote_temp_filter_.isEnabled()) {
+        ESP_LOGI(TAG, "  Remote temperature filter: outliers %.1f °C, median of %u, EMA %.2f, min change %.2f °C",
+            this->remote_temp_filter_.getOutlierDelta(), static_cast<unsigned int>(this->remote_temp_filter_.getWindow()),
+            this->remote_temp_filter_.getEmaAlpha(), this->remote_temp_filter_.getMinChange());
+    }
+}
+
+void MitsubishiHeatPump::dump_latency() {
+    if (this->hpControlFlow_ != nullptr) {
+        this->hpControlFlow_->logLatency();
+    }
+    if (this->remote_temp_filter_.isEnabled()) {
+        ESP_LOGI(TAG, "Remote temperature filter: %u samples, %u outliers, %u forwarded",
+            static_cast<unsigned int>(this->remote_temp_filter_.getSamples()),
+            static_cast<unsigned int>(this->remote_temp_filter_.getRejected()),
+            static_cast<unsigned int>(this->remote_temp_filter_.getForwarded()));
+    }
+}
+
+void MitsubishiHeatPump::dump_frames() {
+    if (this->hpControlFlow_ != nullptr) {
+        this->hpControlFlow_->logFrames();
+    }
+}
+
+void MitsubishiHeatPump::publish_latency() {
+    if (this->response_latency_p50 == nullptr && this->response_latency_p95 == nullptr && this->response_latency_max == nullptr) {
+        return;
+    }
+    // one distribution over all request codes keeps the entity count fixed, dump_latency() gives the per-code split
+    devicestate::LatencyHistogram merged;
+    this->hpControlFlow_->mergeLatency(merged);
+    if (merged.getCount() == 0) {
+        return;
+    }
+
+    auto publishIfChanged = [](esphome::sensor::Sensor* sensor, uint32_t value) {
+        if (sensor != nullptr && (!sensor->has_state() || sensor->state != static_cast<float>(value))) {
+            sensor->publish_state(value);
+        }
+    };
+    publishIfChanged(this->response_latency_p50, merged.percentile(50));
+    publishIfChanged(this->response_latency_p95, merged.percentile(95));
+    publishIfChanged(this->response_latency_max, merged.getMax());
 }
 
 void MitsubishiHeatPump::dump_state() {
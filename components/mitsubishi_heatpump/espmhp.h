@@ -24,6 +24,7 @@
 #include "logging.h"
 
 #include "devicestatemanager.h"
+#include "remote_temp_filter.h"
 
 #include "esphome.h"
 #include "esphome/components/binary_sensor/binary_sensor.h"
@@ -80,6 +81,9 @@ class MitsubishiHeatPump : public esphome::Component, public esphome::climate::C
         esphome::sensor::Sensor* device_status_runtime_hours;
         esphome::sensor::Sensor* pid_set_point_correction;
         esphome::sensor::Sensor* device_set_point;
+        esphome::sensor::Sensor* response_latency_p50{nullptr};
+        esphome::sensor::Sensor* response_latency_p95{nullptr};
+        esphome::sensor::Sensor* response_latency_max{nullptr};
 
         // Print a banner with library information.
         void banner();
@@ -98,6 +102,40 @@ class MitsubishiHeatPump : public esphome::Component, public esphome::climate::C
         void set_remote_temp_timeout(uint32_t timeout);
         void set_debounce_delay(uint32_t delay);
 
+        // Bounds of the adaptive gap kept between two frames sent to the heatpump.
+        void set_min_frame_interval(uint32_t interval) { this->min_frame_interval_ = interval; }
+        void set_max_frame_interval(uint32_t interval) { this->max_frame_interval_ = interval; }
+
+        // Remote temperature changes of at least delta (°C) skip the batching with the polling cycle.
+        void set_remote_temp_fast_path(float delta, uint32_t min_interval) {
+            this->remote_temp_fast_delta_ = delta;
+            this->remote_temp_fast_interval_ = min_interval;
+        }
+
+        // Remote temperature sent as alternating half degrees averaging to the reading, one step per interval.
+        void set_remote_temp_dithering(uint32_t interval) { this->remote_temp_dither_interval_ = interval; }
+
+        // Outlier rejection, median of window samples, EMA and minimum change applied to the remote temperature samples.
+        void set_remote_temp_filter(uint8_t window, float outlier_delta, float ema_alpha, float min_change) {
+            this->remote_temp_filter_.configure(window, outlier_delta, ema_alpha, min_change);
+        }
+
+        // Sensors are published when they move past their deadband, or every heartbeat otherwise (0: never).
+        void set_publish_heartbeat(uint32_t heartbeat) { this->publish_heartbeat_ = heartbeat; }
+        void set_publish_deadband(devicestate::PublishedSensor sensor, float deadband) {
+            this->publish_deadbands_[sensor] = deadband;
+        }
+
+        // Time (µs) the state publication queued by a cycle may take in one loop, 0: all at once.
+        // Checked between steps, so one step may overrun it.
+        void set_publish_budget(uint32_t budget) { this->publish_budget_ = budget; }
+
+        // Bounds of the per-code poll intervals, learned from how often each response changes.
+        void set_adaptive_polling(uint32_t min_interval, uint32_t max_interval) {
+            this->min_poll_interval_ = min_interval;
+            this->max_poll_interval_ = max_interval;
+        }
+
         // handle a change in device;
         void updateDevice();
 
@@ -122,6 +160,12 @@ class MitsubishiHeatPump : public esphome::Component, public esphome::climate::C
         // Debugging function to print the object's state.
         void dump_state();
 
+        // Log the round-trip histograms of every request and write (callable from a lambda).
+        void dump_latency();
+
+        // Log the last frames exchanged with the heatpump (callable from a lambda).
+        void dump_frames();
+
         // Handle a request from the user to change settings.
         void control(const esphome::climate::ClimateCall &call) override;
 
@@ -192,6 +236,18 @@ class MitsubishiHeatPump : public esphome::Component, public esphome::climate::C
             this->device_set_point = device_set_point;
         }
 
+        void set_response_latency_p50_sensor(esphome::sensor::Sensor* response_latency_p50) {
+            this->response_latency_p50 = response_latency_p50;
+        }
+
+        void set_response_latency_p95_sensor(esphome::sensor::Sensor* response_latency_p95) {
+            this->response_latency_p95 = response_latency_p95;
+        }
+
+        void set_response_latency_max_sensor(esphome::sensor::Sensor* response_latency_max) {
+            this->response_latency_max = response_latency_max;
+        }
+
     protected:
         // HeatPump object using the underlying Arduino library.
         devicestate::DeviceStateManager* dsm{nullptr};
@@ -244,6 +300,16 @@ class MitsubishiHeatPump : public esphome::Component, public esphome::climate::C
 
         uint32_t debounce_delay_;
         uint32_t remote_temp_timeout_;
+        uint32_t min_frame_interval_ = devicestate::MIN_SEND_INTERVAL_FLOOR_MS;
+        uint32_t max_frame_interval_ = devicestate::MIN_SEND_INTERVAL_MS;
+        uint32_t min_poll_interval_ = 0;
+        uint32_t max_poll_interval_ = 0;   // 0: every code is polled each cycle
+        float remote_temp_fast_delta_ = devicestate::REMOTE_TEMP_FAST_DELTA_DEFAULT;
+        uint32_t remote_temp_fast_interval_ = devicestate::REMOTE_TEMP_FAST_INTERVAL_DEFAULT_MS;
+        uint32_t remote_temp_dither_interval_ = 0;   // 0: half degree rounding
+        devicestate::RemoteTempFilter remote_temp_filter_;
+        uint32_t publish_heartbeat_ = devicestate::PUBLISH_HEARTBEAT_DEFAULT_MS;
+        float publish_deadbands_[devicestate::PublishedSensor_Count] = {NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN};   // NAN: default
 
         devicestate::CN105ControlFlow* hpControlFlow_{nullptr};
         devicestate::CN105State* hpState_{nullptr};
@@ -251,6 +317,22 @@ class MitsubishiHeatPump : public esphome::Component, public esphome::climate::C
         void controlDelegate(const esphome::climate::ClimateCall &call);
         void terminateCycle();
 
+        // deferred publication: a cycle end only queues tasks, loop() runs them under publish_budget_.
+        // A step is never interrupted: a single one (the climate entity mostly) may still overrun the budget.
+        enum PublishTask : uint8_t {
+            PublishTask_Update = 1 << 0,      // dsm->update()
+            PublishTask_Device = 1 << 1,      // updateDevice(): climate entity and vane selects
+            PublishTask_Workflows = 1 << 2,   // hysterisis and PID
+            PublishTask_Sensors = 1 << 3,     // device sensors, one per step
+            PublishTask_Latency = 1 << 4      // latency sensors
+        };
+        uint8_t pending_publish_ = 0;
+        uint8_t publish_sensor_ = 0;          // next device sensor of PublishTask_Sensors
+        uint32_t publish_budget_ = devicestate::PUBLISH_BUDGET_DEFAULT_US;
+        void queue_publish(uint8_t tasks);
+        void run_publish_tasks();
+        void run_publish_step();
+
         /// The current temperature of the climate device, as reported from the integration.
         float remote_temperature{NAN};
         bool remote_temperature_updated{false};
@@ -282,10 +364,12 @@ class MitsubishiHeatPump : public esphome::Component, public esphome::climate::C
 
         void run_workflows();
 
+        void publish_latency();
+
         bool isComponentActive();
 
         bool hasLastDeviceSnapshot{false};
-        devicestate::DeviceState lastDeviceState{};
+        devicestate::PackedDeviceState lastDeviceState{0};
         devicestate::DeviceStatus lastDeviceStatus{};
 
         float min_temp;
@@ -0,0 +1,57 @@
+#include "frame_capture.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "esphome.h"
+
+namespace devicestate {
+
+    void FrameCapture::record(FrameDirection direction, const uint8_t* frame, int length, uint32_t timestamp_ms) {
+        if (length <= 0) {
+            return;
+        }
+        CapturedFrame& slot = this->frames_[this->head_];
+        slot.timestamp_ms = timestamp_ms;
+        slot.direction = direction;
+        slot.length = static_cast<uint8_t>(length > 0xFF ? 0xFF : length);
+        memcpy(slot.bytes, frame, length < PACKET_LEN ? length : PACKET_LEN);
+
+        this->head_ = (this->head_ + 1) % FRAME_CAPTURE_CAPACITY;
+        if (this->count_ < FRAME_CAPTURE_CAPACITY) {
+            this->count_++;
+        }
+    }
+
+    void FrameCapture::clear() {
+        this->head_ = 0;
+        this->count_ = 0;
+    }
+
+    int FrameCapture::size() const {
+        return this->count_;
+    }
+
+    const CapturedFrame& FrameCapture::at(int i) const {
+        const int oldest = (this->head_ - this->count_ + FRAME_CAPTURE_CAPACITY) % FRAME_CAPTURE_CAPACITY;
+        return this->frames_[(oldest + i) % FRAME_CAPTURE_CAPACITY];
+    }
+
+    void FrameCapture::log(const char* tag) const {
+        ESP_LOGI(tag, "%d captured frame(s), oldest first", this->count_);
+        char hex[PACKET_LEN * 3 + 1];
+        for (int i = 0; i < this->count_; i++) {
+            const CapturedFrame& frame = this->at(i);
+            const int stored = frame.length < PACKET_LEN ? frame.length : PACKET_LEN;
+            int pos = 0;
+            for (int b = 0; b < stored; b++) {
+                pos += snprintf(hex + pos, sizeof(hex) - pos, "%s%02X", b ? " " : "", frame.bytes[b]);
+            }
+            hex[pos] = '\0';
+            ESP_LOGI(tag, "%s %u %u %s%s", frame.direction == FrameDirection_TX ? "TX" : "RX",
+                static_cast<unsigned int>(frame.timestamp_ms), static_cast<unsigned int>(frame.length),
+                hex, frame.length > PACKET_LEN ? " ..." : "");
+        }
+    }
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cn105_types.h"
+
+namespace devicestate {
+
+    static const int FRAME_CAPTURE_CAPACITY = 32;
+
+    enum FrameDirection : uint8_t {
+        FrameDirection_RX = 0,
+        FrameDirection_TX = 1
+    };
+
+    /**
+     * One captured frame, 28 bytes. Frames longer than PACKET_LEN are truncated,
+     * length keeps the size seen on the wire.
+     */
+    struct CapturedFrame {
+        uint32_t timestamp_ms;
+        FrameDirection direction;
+        uint8_t length;
+        uint8_t bytes[PACKET_LEN];
+    };
+
+    /**
+     * @class FrameCapture
+     * @brief In-RAM ring buffer of the last frames exchanged with the heatpump.
+     *
+     * Cheap enough to stay on in production: recording is a bounded memcpy into
+     * a static array, formatting only happens when the buffer is dumped.
+     */
+    class FrameCapture {
+    public:
+        void record(FrameDirection direction, const uint8_t* frame, int length, uint32_t timestamp_ms);
+        void clear();
+
+        int size() const;
+        // i = 0 is the oldest frame still in the buffer
+        const CapturedFrame& at(int i) const;
+
+        // one line per frame, oldest first: "<RX|TX> <millis> <length> FC 62 01 30 ..."
+        void log(const char* tag) const;
+
+    private:
+        CapturedFrame frames_[FRAME_CAPTURE_CAPACITY];
+        int head_ = 0;                // next slot to write
+        int count_ = 0;
+    };
+
+}
@@ -0,0 +1,129 @@
+#include "frame_pacing.h"
+
+#include "esphome.h"
+
+namespace devicestate {
+
+    static const char* TAG = "FramePacing"; // Logging tag
+
+    void LatencyEstimate::add(uint32_t rtt) {
+        if (this->samples == 0) {
+            this->srtt = rtt;
+            this->rttvar = rtt / 2;
+        } else {
+            const uint32_t err = (rtt > this->srtt) ? (rtt - this->srtt) : (this->srtt - rtt);
+            this->rttvar = (3 * this->rttvar + err) / 4;
+            this->srtt = (7 * this->srtt + rtt) / 8;
+        }
+        if (rtt > this->max) {
+            this->max = rtt;
+        }
+        this->samples++;
+    }
+
+    uint32_t LatencyEstimate::bound() const {
+        return this->srtt + 4 * this->rttvar;
+    }
+
+    FramePacing::FramePacing(uint32_t floor_ms, uint32_t ceiling_ms) {
+        this->set_bounds(floor_ms, ceiling_ms);
+    }
+
+    void FramePacing::set_bounds(uint32_t floor_ms, uint32_t ceiling_ms) {
+        if (ceiling_ms < floor_ms) {
+            ESP_LOGW(TAG, "ceiling %u ms is below floor %u ms, using the floor for both",
+                static_cast<unsigned int>(ceiling_ms), static_cast<unsigned int>(floor_ms));
+            ceiling_ms = floor_ms;
+        }
+        this->floor_ms_ = floor_ms;
+        this->ceiling_ms_ = ceiling_ms;
+    }
+
+    FramePacing::LatencyClass FramePacing::classify(uint8_t command, uint8_t code) {
+        switch (command) {
+        case 0x41:
+            return LatencyClass_Write;
+        case 0x5A:
+        case 0x5B:
+            return LatencyClass_Connect;
+        default:
+            break;
+        }
+        switch (code) {
+        case 0x02: return LatencyClass_Settings;
+        case 0x03: return LatencyClass_RoomTemp;
+        case 0x06: return LatencyClass_Status;
+        case 0x09: return LatencyClass_Standby;
+        default: return LatencyClass_OtherInfo;
+        }
+    }
+
+    void FramePacing::onSent(const uint8_t* packet, int length, uint32_t now) {
+        if (length < 6) {
+            return;
+        }
+        this->awaiting_ = true;
+        this->awaitedCommand_ = packet[1];
+        this->awaitedCode_ = packet[5];
+        this->awaitedClass_ = classify(packet[1], packet[5]);
+        this->sentMs_ = now;
+    }
+
+    bool FramePacing::onResponse(uint8_t command, uint8_t code, uint32_t now, uint32_t* rtt) {
+        // a response command is the request command + 0x20 (0x42->0x62, 0x41->0x61, 0x5A->0x7A)
+        if (!this->awaiting_ || command != static_cast<uint8_t>(this->awaitedCommand_ + 0x20)) {
+            return false;
+        }
+        if (command == 0x62 && code != this->awaitedCode_) {
+            return false;
+        }
+        this->awaiting_ = false;
+
+        const uint32_t sample = now - this->sentMs_;
+        LatencyEstimate& estimate = this->estimates_[this->awaitedClass_];
+        estimate.add(sample);
+        ESP_LOGV(TAG, "round-trip %02X/%02X: %u ms (srtt: %u ms, bound: %u ms)",
+            this->awaitedCommand_, this->awaitedCode_, static_cast<unsigned int>(sample),
+            static_cast<unsigned int>(estimate.srtt), static_cast<unsigned int>(estimate.bound()));
+        if (rtt != nullptr) {
+            *rtt = sample;
+        }
+        return true;
+    }
+
+    uint32_t FramePacing::clampGap(uint32_t value) const {
+        if (value < this->floor_ms_) return this->floor_ms_;
+        if (value > this->ceiling_ms_) return this->ceiling_ms_;
+        return value;
+    }
+
+    uint32_t FramePacing::getSendGap() const {
+        if (!this->awaiting_) {
+            return this->floor_ms_;
+        }
+        const LatencyEstimate& estimate = this->estimates_[this->awaitedClass_];
+        if (estimate.samples == 0) {
+            return this->ceiling_ms_;
+        }
+        return this->clampGap(estimate.bound());
+    }
+
+    bool FramePacing::isAwaitingResponse(uint32_t now) const {
+        return this->awaiting_ && (now - this->sentMs_) < this->getSendGap();
+    }
+
+    uint32_t FramePacing::getWriteSettleDelay() const {
+        const LatencyEstimate& estimate = this->estimates_[LatencyClass_Write];
+        if (estimate.samples == 0) {
+            // nothing learned yet: rest as long as the ceiling, like the send gap
+            return this->ceiling_ms_;
+        }
+        // within the configured frame interval bounds, like the send gap
+        return this->clampGap(estimate.bound());
+    }
+
+    const LatencyEstimate& FramePacing::getEstimate(LatencyClass latencyClass) const {
+        return this->estimates_[latencyClass];
+    }
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cn105_types.h"
+
+namespace devicestate {
+
+    /**
+     * Smoothed round-trip estimate (Jacobson/Karels, integer milliseconds).
+     */
+    struct LatencyEstimate {
+        uint32_t srtt = 0;            // smoothed round-trip time
+        uint32_t rttvar = 0;          // smoothed mean deviation
+        uint32_t max = 0;             // worst round-trip seen
+        uint32_t samples = 0;
+
+        void add(uint32_t rtt);
+        uint32_t bound() const;       // srtt + 4 * rttvar
+    };
+
+    /**
+     * @class FramePacing
+     * @brief Learns the request -> response round-trip of the heatpump and derives
+     * the minimum gap to keep between two frames.
+     *
+     * Each request class (info code, set packet, connect) has its own estimate.
+     * While a frame is still waiting for its response, the next one is held back
+     * for the learned bound of that class; once the response is in, only the floor
+     * applies. The gap always stays within [floor, ceiling]; a class without any
+     * sample yet uses the ceiling, i.e. the historical fixed gap.
+     */
+    class FramePacing {
+    public:
+        enum LatencyClass : uint8_t {
+            LatencyClass_Settings = 0,    // 0x42/0x02
+            LatencyClass_RoomTemp,        // 0x42/0x03
+            LatencyClass_Status,          // 0x42/0x06
+            LatencyClass_Standby,         // 0x42/0x09
+            LatencyClass_OtherInfo,       // other 0x42 codes
+            LatencyClass_Write,           // 0x41 set packets, acknowledged by 0x61
+            LatencyClass_Connect,         // 0x5A/0x5B, answered by 0x7A/0x7B
+            LatencyClass_Count
+        };
+
+        FramePacing(uint32_t floor_ms = MIN_SEND_INTERVAL_FLOOR_MS, uint32_t ceiling_ms = MIN_SEND_INTERVAL_MS);
+
+        void set_bounds(uint32_t floor_ms, uint32_t ceiling_ms);
+        uint32_t get_floor() const { return floor_ms_; }
+        uint32_t get_ceiling() const { return ceiling_ms_; }
+
+        void onSent(const uint8_t* packet, int length, uint32_t now);
+        // returns true when the response matches the awaited request, its round-trip goes to rtt
+        bool onResponse(uint8_t command, uint8_t code, uint32_t now, uint32_t* rtt = nullptr);
+        // code (packet[5]) of the last request sent
+        uint8_t getLastRequestCode() const { return this->awaitedCode_; }
+
+        // minimum time to wait after the last sent frame before sending the next one
+        uint32_t getSendGap() const;
+        // a frame is waiting for its response and its learned bound is not over yet
+        bool isAwaitingResponse(uint32_t now) const;
+        // rest time to give the heatpump after a settings write, within the bounds, the ceiling while no write was acknowledged yet
+        uint32_t getWriteSettleDelay() const;
+
+        const LatencyEstimate& getEstimate(LatencyClass latencyClass) const;
+
+    private:
+        LatencyEstimate estimates_[LatencyClass_Count];
+        uint32_t floor_ms_;
+        uint32_t ceiling_ms_;
+
+        bool awaiting_ = false;
+        uint8_t awaitedCommand_ = 0;
+        uint8_t awaitedCode_ = 0;
+        LatencyClass awaitedClass_ = LatencyClass_OtherInfo;
+        uint32_t sentMs_ = 0;
+
+        uint32_t clampGap(uint32_t value) const;
+        static LatencyClass classify(uint8_t command, uint8_t code);
+    };
+
+}
@@ -1,3 +1,5 @@
+#include "hysterisis_workflowstep.h"
+
 #include "esphome.h"
 using namespace esphome;
 
@@ -1,15 +1,19 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
-#include <string>
 #include <cstdio>
 
+#include "latency_histogram.h"
+
 namespace devicestate {
 
     class CN105State; // forward declaration
 
     struct InfoRequest {
+        // Plain function pointers: owner is handed back as-is, so registering or running a request never allocates
+        using CanSendFn = bool (*)(void* owner, const CN105State&);
+        using ResponseFn = void (*)(void* owner, CN105State&);
+
         const char* id;
         const char* description;
         uint8_t code;                 // e.g. 0x02, 0x03, 0x06, 0x09, 0x42
@@ -20,14 +24,22 @@ namespace devicestate {
         uint32_t soft_timeout_ms;     // optional: skip forward on timeout without blocking cycle
         uint32_t interval_ms;         // Minimum time between requests for this specific code
         uint32_t last_request_time;   // Last time this request was sent (millis)
-        std::string timeout_name;     // unique scheduler name for soft-timeout
+        uint32_t adaptive_interval_ms; // interval learned in adaptive polling mode (0: every cycle)
+        uint32_t payload_hash;        // hash of the last response payload, to tell changes apart
+        bool payload_seen;            // payload_hash is valid
+        char timeout_name[20];        // unique scheduler name for soft-timeout
         const char* log_tag;          // Custom log tag (optional), defaults to LOG_CYCLE_TAG logic
+        LatencyHistogram latency;     // round-trips from last_request_time to the matching response
+
+        void* owner;                  // first argument of canSend and onResponse
 
         // Optional condition to decide whether this request should be sent in this device/config
-        std::function<bool(const CN105State&)> canSend;
+        CanSendFn canSend;
 
         // Optional response handler invoked when the matching response (code) is received
-        std::function<void(CN105State&)> onResponse;
+        ResponseFn onResponse;
+
+        InfoRequest() : InfoRequest(nullptr, nullptr, 0x00) {}
 
         InfoRequest(
             const char* id,
@@ -37,12 +49,8 @@ namespace devicestate {
             uint32_t soft_timeout_ms = 0,
             uint32_t interval_ms = 0,
             const char* log_tag = nullptr
-        ) : id(id), description(description), code(code), maxFailures(maxFailures), failures(0), disabled(false), awaiting(false), soft_timeout_ms(soft_timeout_ms), interval_ms(interval_ms), last_request_time(0), timeout_name(""), log_tag(log_tag), canSend(nullptr), onResponse(nullptr) {
-            char buf[32];
-            std::snprintf(buf, sizeof(buf), "info_timeout_0x%02X", code);
-            timeout_name = buf;
+        ) : id(id), description(description), code(code), maxFailures(maxFailures), failures(0), disabled(false), awaiting(false), soft_timeout_ms(soft_timeout_ms), interval_ms(interval_ms), last_request_time(0), adaptive_interval_ms(0), payload_hash(0), payload_seen(false), log_tag(log_tag), owner(nullptr), canSend(nullptr), onResponse(nullptr) {
+            std::snprintf(timeout_name, sizeof(timeout_name), "info_timeout_0x%02X", code);
         }
     };
 }
-
-
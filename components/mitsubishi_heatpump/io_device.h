@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 namespace devicestate {
@@ -9,6 +10,24 @@ namespace devicestate {
         virtual void write(uint8_t) = 0;
         virtual int available(void) = 0;
         virtual bool read(uint8_t*) = 0;
+
+        // Writes a whole frame in one call. Default implementation falls back to the per-byte write().
+        virtual void write_array(const uint8_t* data, size_t len) {
+            for (size_t i = 0; i < len; i++) {
+                this->write(data[i]);
+            }
+        }
+
+        // Bulk read of up to len bytes, returns the number of bytes copied into data.
+        // Default implementation falls back to the per-byte read().
+        virtual size_t read_array(uint8_t* data, size_t len) {
+            size_t count = 0;
+            while (count < len && this->read(&data[count])) {
+                count++;
+            }
+            return count;
+        }
+
         virtual ~IIODevice() = default;    // Virtual destructor for safety
     };
 
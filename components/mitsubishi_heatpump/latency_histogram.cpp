@@ -0,0 +1,73 @@
+#include "latency_histogram.h"
+
+#include <cstdio>
+
+#include "esphome.h"
+
+namespace devicestate {
+
+    const uint16_t LatencyHistogram::BUCKET_EDGES_MS[LatencyHistogram::BUCKET_COUNT - 1] = {
+        20, 40, 60, 80, 100, 150, 200, 300, 500, 750, 1000, 2000
+    };
+
+    void LatencyHistogram::record(uint32_t latency_ms) {
+        uint8_t bucket = 0;
+        while (bucket < BUCKET_COUNT - 1 && latency_ms > BUCKET_EDGES_MS[bucket]) {
+            bucket++;
+        }
+        this->buckets_[bucket]++;
+        this->count_++;
+        if (latency_ms > this->max_) {
+            this->max_ = latency_ms;
+        }
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+            this->buckets_[i] += other.buckets_[i];
+        }
+        this->count_ += other.count_;
+        if (other.max_ > this->max_) {
+            this->max_ = other.max_;
+        }
+    }
+
+    void LatencyHistogram::reset() {
+        for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+            this->buckets_[i] = 0;
+        }
+        this->count_ = 0;
+        this->max_ = 0;
+    }
+
+    uint32_t LatencyHistogram::percentile(uint8_t p) const {
+        if (this->count_ == 0) {
+            return 0;
+        }
+        // rank of the sample we are looking for, rounded up
+        const uint64_t rank = (static_cast<uint64_t>(this->count_) * p + 99) / 100;
+        uint64_t seen = 0;
+        for (uint8_t i = 0; i < BUCKET_COUNT - 1; i++) {
+            seen += this->buckets_[i];
+            if (seen >= rank && seen > 0) {
+                return (BUCKET_EDGES_MS[i] < this->max_) ? BUCKET_EDGES_MS[i] : this->max_;
+            }
+        }
+        return this->max_;
+    }
+
+    void LatencyHistogram::log(const char* tag, const char* name) const {
+        char buckets[BUCKET_COUNT * 11 + 1];
+        int pos = 0;
+        for (uint8_t i = 0; i < BUCKET_COUNT && pos < static_cast<int>(sizeof(buckets)); i++) {
+            pos += snprintf(buckets + pos, sizeof(buckets) - pos, "%s%u", i ? " " : "", static_cast<unsigned int>(this->buckets_[i]));
+        }
+        ESP_LOGI(tag, "%s: n=%u p50=%ums p95=%ums max=%ums [%s]", name,
+            static_cast<unsigned int>(this->count_),
+            static_cast<unsigned int>(this->percentile(50)),
+            static_cast<unsigned int>(this->percentile(95)),
+            static_cast<unsigned int>(this->max_),
+            buckets);
+    }
+
+}
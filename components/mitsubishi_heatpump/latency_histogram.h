@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+namespace devicestate {
+
+    /**
+     * @class LatencyHistogram
+     * @brief Fixed-bucket histogram of request -> response round-trips (milliseconds).
+     *
+     * No allocation; percentiles are resolved to the upper edge of the bucket
+     * they fall in, the overflow bucket resolves to the worst value seen.
+     */
+    class LatencyHistogram {
+    public:
+        static const uint8_t BUCKET_COUNT = 13;
+        static const uint16_t BUCKET_EDGES_MS[BUCKET_COUNT - 1];
+
+        void record(uint32_t latency_ms);
+        void merge(const LatencyHistogram& other);
+        void reset();
+
+        // p in [0, 100], 0 when nothing was recorded
+        uint32_t percentile(uint8_t p) const;
+        uint32_t getCount() const { return this->count_; }
+        uint32_t getMax() const { return this->max_; }
+        uint32_t getBucket(uint8_t index) const { return this->buckets_[index]; }
+
+        // one line summary (count, p50, p95, max and the raw buckets) under tag
+        void log(const char* tag, const char* name) const;
+
+    private:
+        uint32_t buckets_[BUCKET_COUNT] = {};
+        uint32_t count_ = 0;
+        uint32_t max_ = 0;
+    };
+
+}
@@ -4,6 +4,7 @@
 using namespace esphome;
 
 #include "devicestatemanager.h"
+#include "floats.h"
 using namespace devicestate;
 
 namespace workflow {
@@ -0,0 +1,92 @@
+#include "remote_temp_filter.h"
+
+#include <cmath>
+
+#include "esphome.h"
+
+namespace devicestate {
+
+    static const char* TAG = "RemoteTempFilter"; // Logging tag
+
+    void RemoteTempFilter::configure(uint8_t window, float outlier_delta, float ema_alpha, float min_change) {
+        if (window < 1) {
+            window = 1;
+        } else if (window > REMOTE_TEMP_FILTER_MAX_WINDOW) {
+            window = REMOTE_TEMP_FILTER_MAX_WINDOW;
+        }
+        if (!(ema_alpha > 0) || ema_alpha > 1.0f) {
+            ema_alpha = 1.0f;
+        }
+        this->window_ = window;
+        this->outlierDelta_ = outlier_delta > 0 ? outlier_delta : 0;
+        this->emaAlpha_ = ema_alpha;
+        this->minChange_ = min_change > 0 ? min_change : 0;
+        this->reset();
+    }
+
+    bool RemoteTempFilter::isEnabled() const {
+        return this->window_ > 1 || this->outlierDelta_ > 0 || this->emaAlpha_ < 1.0f || this->minChange_ > 0;
+    }
+
+    bool RemoteTempFilter::push(float sample, float& out) {
+        this->samples_++;
+
+        if (this->outlierDelta_ > 0 && this->count_ > 0 && std::fabs(sample - this->median()) > this->outlierDelta_) {
+            this->rejected_++;
+            if (++this->rejectRun_ < REMOTE_TEMP_FILTER_MAX_REJECTS) {
+                ESP_LOGD(TAG, "Outlier %.2f dropped (median %.2f)", sample, this->median());
+                return false;
+            }
+            // the readings really moved: start over from this one
+            ESP_LOGD(TAG, "%d outliers in a row, restarting from %.2f", this->rejectRun_, sample);
+            this->head_ = 0;
+            this->count_ = 0;
+            this->hasEma_ = false;
+        }
+        this->rejectRun_ = 0;
+
+        this->ring_[this->head_] = sample;
+        this->head_ = (this->head_ + 1) % this->window_;
+        if (this->count_ < this->window_) {
+            this->count_++;
+        }
+
+        const float median = this->median();
+        this->ema_ = this->hasEma_ ? this->ema_ + this->emaAlpha_ * (median - this->ema_) : median;
+        this->hasEma_ = true;
+
+        if (this->hasForwarded_ && std::fabs(this->ema_ - this->lastForwarded_) < this->minChange_) {
+            return false;
+        }
+        this->hasForwarded_ = true;
+        this->lastForwarded_ = this->ema_;
+        this->forwarded_++;
+        out = this->ema_;
+        return true;
+    }
+
+    void RemoteTempFilter::reset() {
+        this->head_ = 0;
+        this->count_ = 0;
+        this->rejectRun_ = 0;
+        this->hasEma_ = false;
+        this->hasForwarded_ = false;
+    }
+
+    float RemoteTempFilter::median() const {
+        // insertion sort of a copy, the window is a handful of samples
+        float sorted[REMOTE_TEMP_FILTER_MAX_WINDOW];
+        for (uint8_t i = 0; i < this->count_; i++) {
+            const float value = this->ring_[i];
+            uint8_t j = i;
+            while (j > 0 && sorted[j - 1] > value) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = value;
+        }
+        const uint8_t middle = this->count_ / 2;
+        return (this->count_ % 2 == 1) ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2.0f;
+    }
+
+}
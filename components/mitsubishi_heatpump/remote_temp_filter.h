@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+namespace devicestate {
+
+    static const uint8_t REMOTE_TEMP_FILTER_MAX_WINDOW = 9;
+    // consecutive outliers taken as a real step of the readings
+    static const uint8_t REMOTE_TEMP_FILTER_MAX_REJECTS = 3;
+
+    /**
+     * @class RemoteTempFilter
+     * @brief Filter stage between the remote temperature sensor and the heatpump.
+     *
+     * Each sample goes through outlier rejection (distance to the median of the
+     * window), a median of the last N samples and an EMA; the result is forwarded
+     * only once it moved at least min_change from the last forwarded value.
+     * The window is a fixed ring buffer, no allocation. Unconfigured, every
+     * sample is forwarded unchanged.
+     */
+    class RemoteTempFilter {
+    public:
+        /**
+         * @param window        median of the last window samples (1..REMOTE_TEMP_FILTER_MAX_WINDOW)
+         * @param outlier_delta samples further than this (°C) from the median are dropped, 0: never
+         * @param ema_alpha     weight of the new median in the EMA, 1: no smoothing
+         * @param min_change    smallest change (°C) of the filtered value worth forwarding
+         */
+        void configure(uint8_t window, float outlier_delta, float ema_alpha, float min_change);
+        bool isEnabled() const;
+
+        /**
+         * @brief Feeds a sensor sample
+         * @return true with the value to forward in out, false when the sample is absorbed
+         */
+        bool push(float sample, float& out);
+
+        // forgets the window and the last forwarded value, counters are kept
+        void reset();
+
+        uint8_t getWindow() const { return this->window_; }
+        float getOutlierDelta() const { return this->outlierDelta_; }
+        float getEmaAlpha() const { return this->emaAlpha_; }
+        float getMinChange() const { return this->minChange_; }
+
+        uint32_t getSamples() const { return this->samples_; }
+        uint32_t getRejected() const { return this->rejected_; }
+        uint32_t getForwarded() const { return this->forwarded_; }
+
+    private:
+        uint8_t window_ = 1;
+        float outlierDelta_ = 0;
+        float emaAlpha_ = 1.0f;
+        float minChange_ = 0;
+
+        float ring_[REMOTE_TEMP_FILTER_MAX_WINDOW] = {};
+        uint8_t head_ = 0;            // next slot written
+        uint8_t count_ = 0;
+        uint8_t rejectRun_ = 0;
+        bool hasEma_ = false;
+        float ema_ = 0;
+        bool hasForwarded_ = false;
+        float lastForwarded_ = 0;
+
+        uint32_t samples_ = 0;
+        uint32_t rejected_ = 0;
+        uint32_t forwarded_ = 0;
+
+        float median() const;
+    };
+
+}
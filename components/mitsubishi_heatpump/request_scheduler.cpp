@@ -1,6 +1,8 @@
 #include "request_scheduler.h"
 #include "Globals.h"
 #include <esphome.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace devicestate;
 
@@ -11,32 +13,56 @@ namespace devicestate {
         TimeoutCallback timeout_callback,
         TerminateCallback terminate_callback,
         ContextCallback context_callback
-    ) : current_request_index_(-1),
+    ) : request_count_(0),
+    current_request_index_(-1),
+    adaptive_min_ms_(0),
+    adaptive_max_ms_(0),
     send_callback_(send_callback),
     timeout_callback_(timeout_callback),
     terminate_callback_(terminate_callback),
-    context_callback_(context_callback) {}
+    context_callback_(context_callback) {
+        std::memset(slot_by_code_, -1, sizeof(slot_by_code_));
+    }
 
-    void RequestScheduler::register_request(InfoRequest& req) {
-        requests_.push_back(req);
+    bool RequestScheduler::register_request(const InfoRequest& req) {
+        if (slot_by_code_[req.code] >= 0) {
+            ESP_LOGE(LOG_CYCLE_TAG, "%s (0x%02X) is already registered", req.description, req.code);
+            return false;
+        }
+        if (request_count_ >= MAX_REQUESTS) {
+            ESP_LOGE(LOG_CYCLE_TAG, "Cannot register %s (0x%02X): all %d request slots are used",
+                req.description, req.code, MAX_REQUESTS);
+            return false;
+        }
+        requests_[request_count_] = req;
+        slot_by_code_[req.code] = static_cast<int8_t>(request_count_);
+        request_count_++;
+        return true;
     }
 
     void RequestScheduler::clear_requests() {
-        requests_.clear();
+        for (uint8_t i = 0; i < request_count_; ++i) {
+            requests_[i] = InfoRequest();
+        }
+        std::memset(slot_by_code_, -1, sizeof(slot_by_code_));
+        request_count_ = 0;
         current_request_index_ = -1;
     }
 
+    InfoRequest* RequestScheduler::find_request(uint8_t code) {
+        const int8_t slot = slot_by_code_[code];
+        return slot < 0 ? nullptr : &requests_[slot];
+    }
+
     void RequestScheduler::disable_request(uint8_t code) {
-        for (auto& req : requests_) {
-            if (req.code == code) {
-                req.disabled = true;
-                break;
-            }
+        InfoRequest* req = find_request(code);
+        if (req) {
+            req->disabled = true;
         }
     }
 
     bool RequestScheduler::is_empty() const {
-        return requests_.empty();
+        return request_count_ == 0;
     }
 
     void RequestScheduler::send_request(uint8_t code, CN105State* context) {
@@ -45,64 +71,58 @@ namespace devicestate {
             context = context_callback_();
         }
 
-        for (size_t i = 0; i < requests_.size(); ++i) {
-            auto& req = requests_[i];
-            if (req.code != code) continue;
-            if (req.disabled) { return; }
+        InfoRequest* req = find_request(code);
+        if (!req || req->disabled) {
+            return;
+        }
 
-            // Check canSend if present and context is available
-            if (req.canSend && context) {
-                if (!req.canSend(*context)) {
-                    return;
-                }
+        // Check canSend if present and context is available
+        if (req->canSend && context) {
+            if (!req->canSend(req->owner, *context)) {
+                return;
             }
+        }
 
-            const char* tag = req.log_tag ? req.log_tag : LOG_CYCLE_TAG;
-            ESP_LOGD(tag, "Sending %s (0x%02X)", req.description, req.code);
+        const char* tag = req->log_tag ? req->log_tag : LOG_CYCLE_TAG;
+        ESP_LOGD(tag, "Sending %s (0x%02X)", req->description, req->code);
 
-            req.awaiting = true;
-            req.last_request_time = CUSTOM_MILLIS;
+        req->awaiting = true;
+        req->last_request_time = CUSTOM_MILLIS;
 
-            // Send the packet via callback
-            if (send_callback_) {
-                send_callback_(req.code);
-            }
+        // Send the packet via callback
+        if (send_callback_) {
+            send_callback_(req->code);
+        }
 
-            // Handle timeout if configured and callback is available
-            if (req.soft_timeout_ms > 0 && timeout_callback_) {
-                uint8_t code_copy = req.code;
-                const std::string tname = req.timeout_name.empty() ?
-                    (std::string("info_timeout_") + std::to_string(code_copy)) :
-                    req.timeout_name;
-
-                timeout_callback_(tname, req.soft_timeout_ms, [this, code_copy]() {
-                    // Get context for send_next_after
-                    CN105State* ctx = nullptr;
-                    if (this->context_callback_) {
-                        ctx = this->context_callback_();
-                    }
+        // Handle timeout if configured and callback is available
+        if (req->soft_timeout_ms > 0 && timeout_callback_) {
+            // two words of capture stay in std::function's inline storage
+            timeout_callback_(req->timeout_name, req->soft_timeout_ms, [this, code]() {
+                // If response is still awaited, consider it a soft failure and continue
+                InfoRequest* r = this->find_request(code);
+                if (!r || !r->awaiting) {
+                    return;
+                }
+                r->awaiting = false;
+                r->failures++;
+                ESP_LOGW(LOG_CYCLE_TAG, "Soft timeout for %s (0x%02X), failures: %d",
+                    r->description, r->code, r->failures);
+                if (r->failures >= r->maxFailures) {
+                    r->disabled = true;
+                    ESP_LOGW(LOG_CYCLE_TAG, "%s (0x%02X) disabled (not supported)",
+                        r->description, r->code);
+                }
+                this->send_next_after(code);
+            });
+        }
 
-                    // If response is still awaited, consider it a soft failure and continue
-                    for (auto& r : this->requests_) {
-                        if (r.code == code_copy && r.awaiting) {
-                            r.awaiting = false;
-                            r.failures++;
-                            ESP_LOGW(LOG_CYCLE_TAG, "Soft timeout for %s (0x%02X), failures: %d",
-                                r.description, r.code, r.failures);
-                            if (r.failures >= r.maxFailures) {
-                                r.disabled = true;
-                                ESP_LOGW(LOG_CYCLE_TAG, "%s (0x%02X) disabled (not supported)",
-                                    r.description, r.code);
-                            }
-                            this->send_next_after(code_copy, ctx);
-                            break;
-                        }
-                    }
-                    });
-            }
+        current_request_index_ = slot_by_code_[code];
+    }
 
-            current_request_index_ = static_cast<int>(i);
-            return;
+    void RequestScheduler::mark_sent(uint8_t code) {
+        InfoRequest* req = find_request(code);
+        if (req && req->awaiting) {
+            req->last_request_time = CUSTOM_MILLIS;
         }
     }
 
@@ -112,18 +132,20 @@ namespace devicestate {
             context = context_callback_();
         }
 
-        for (auto& req : requests_) {
-            if (req.code == code) {
-                req.awaiting = false;
-                req.failures = 0;
-                ESP_LOGD(LOG_CYCLE_TAG, "Receiving %s (0x%02X)", req.description, req.code);
+        InfoRequest* req = find_request(code);
+        if (!req) {
+            return;
+        }
+        if (req->awaiting) {
+            req->latency.record(CUSTOM_MILLIS - req->last_request_time);
+        }
+        req->awaiting = false;
+        req->failures = 0;
+        ESP_LOGD(LOG_CYCLE_TAG, "Receiving %s (0x%02X)", req->description, req->code);
 
-                // Call onResponse callback if present and context is available
-                if (req.onResponse && context) {
-                    req.onResponse(*context);
-                }
-                return;
-            }
+        // Call onResponse callback if present and context is available
+        if (req->onResponse && context) {
+            req->onResponse(req->owner, *context);
         }
     }
 
@@ -133,17 +155,11 @@ namespace devicestate {
             context = context_callback_();
         }
 
-        // Find starting index (by code) then try next activatable entries in order
-        int start = -1;
-        for (size_t i = 0; i < requests_.size(); ++i) {
-            if (requests_[i].code == previous_code) {
-                start = static_cast<int>(i);
-                break;
-            }
-        }
+        // Start right after the slot of previous_code, then try next activatable entries in order
+        const int start = slot_by_code_[previous_code];
         int idx = (start < 0) ? 0 : start + 1;
 
-        for (; idx < static_cast<int>(requests_.size()); ++idx) {
+        for (; idx < static_cast<int>(request_count_); ++idx) {
             auto& req = requests_[idx];
             if (req.disabled) {
                 if (req.log_tag) {
@@ -154,7 +170,7 @@ namespace devicestate {
 
             // Check canSend if present and context is available
             if (req.canSend && context) {
-                if (!req.canSend(*context)) {
+                if (!req.canSend(req.owner, *context)) {
                     if (req.log_tag) {
                         ESP_LOGD(req.log_tag, "Skipping %s (0x%02X): canSend returned false", req.description, req.code);
                     }
@@ -162,11 +178,12 @@ namespace devicestate {
                 }
             }
 
-            if (req.interval_ms > 0 && (CUSTOM_MILLIS - req.last_request_time < req.interval_ms)) {
+            const uint32_t interval = std::max(req.interval_ms, req.adaptive_interval_ms);
+            if (interval > 0 && (CUSTOM_MILLIS - req.last_request_time < interval)) {
                 if (req.log_tag) {
                     ESP_LOGD(req.log_tag, "Skipping %s (0x%02X) - interval not elapsed (elapsed: %lu, interval: %u)",
                         req.description, req.code,
-                        (unsigned long)(CUSTOM_MILLIS - req.last_request_time), req.interval_ms);
+                        (unsigned long)(CUSTOM_MILLIS - req.last_request_time), interval);
                 }
                 continue;
             }
@@ -183,26 +200,94 @@ namespace devicestate {
     }
 
     bool RequestScheduler::process_response(uint8_t code, CN105State* context) {
+        return process_response(code, nullptr, 0, context);
+    }
+
+    bool RequestScheduler::process_response(uint8_t code, const uint8_t* payload, size_t length, CN105State* context) {
+        if (!receive_response(code, payload, length, context)) return false;
+        send_next_after(code, context);
+        return true;
+    }
+
+    bool RequestScheduler::receive_response(uint8_t code, const uint8_t* payload, size_t length, CN105State* context) {
         // Get context if not provided but callback is available
         if (!context && context_callback_) {
             context = context_callback_();
         }
 
         // Check if the code is handled by the scheduler
-        bool handled = false;
-        for (auto& req : requests_) {
-            if (req.code == code) {
-                handled = true;
-                break;
-            }
-        }
-        if (!handled) return false;
+        if (slot_by_code_[code] < 0) return false;
 
+        adapt_interval(requests_[slot_by_code_[code]], payload, length);
         mark_response_seen(code, context);
-        send_next_after(code, context);
         return true;
     }
 
+    void RequestScheduler::set_adaptive_polling(uint32_t min_interval_ms, uint32_t max_interval_ms) {
+        adaptive_min_ms_ = min_interval_ms;
+        adaptive_max_ms_ = (max_interval_ms > 0) ? std::max(min_interval_ms, max_interval_ms) : 0;
+        expedite_all();
+        if (adaptive_max_ms_ > 0) {
+            ESP_LOGI(LOG_CYCLE_TAG, "Adaptive polling between %u and %u ms",
+                (unsigned int)adaptive_min_ms_, (unsigned int)adaptive_max_ms_);
+        }
+    }
+
+    void RequestScheduler::expedite(uint8_t code) {
+        InfoRequest* req = find_request(code);
+        if (req) {
+            req->adaptive_interval_ms = 0;
+        }
+    }
+
+    void RequestScheduler::expedite_all() {
+        for (uint8_t i = 0; i < request_count_; ++i) {
+            requests_[i].adaptive_interval_ms = 0;
+        }
+    }
+
+    void RequestScheduler::adapt_interval(InfoRequest& req, const uint8_t* payload, size_t length) {
+        if (adaptive_max_ms_ == 0 || payload == nullptr) {
+            return;
+        }
+
+        // FNV-1a, only used to tell two payloads of the same code apart
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ payload[i]) * 16777619u;
+        }
+
+        uint32_t next;
+        if (!req.payload_seen || hash != req.payload_hash) {
+            next = adaptive_min_ms_;
+        } else {
+            next = std::min(std::max(req.adaptive_interval_ms * 2, ADAPTIVE_POLL_MIN_BACKOFF_MS), adaptive_max_ms_);
+        }
+        req.payload_hash = hash;
+        req.payload_seen = true;
+
+        if (next != req.adaptive_interval_ms) {
+            ESP_LOGD(LOG_CYCLE_TAG, "Polling %s (0x%02X) every %u ms", req.description, req.code, (unsigned int)next);
+            req.adaptive_interval_ms = next;
+        }
+    }
+
+    void RequestScheduler::log_latency(const char* tag) const {
+        for (uint8_t i = 0; i < request_count_; ++i) {
+            const auto& req = requests_[i];
+            if (req.latency.getCount() == 0) continue;
+            char name[48];
+            std::snprintf(name, sizeof(name), "%s (0x%02X)", req.description, req.code);
+            req.latency.log(tag, name);
+        }
+    }
+
+    void RequestScheduler::merge_latency(LatencyHistogram& into) const {
+        for (uint8_t i = 0; i < request_count_; ++i) {
+            into.merge(requests_[i].latency);
+        }
+    }
+
     void RequestScheduler::loop() {
         // Currently, timeout management is done via callbacks
         // This method is intended for future management if needed
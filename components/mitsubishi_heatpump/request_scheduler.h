@@ -1,10 +1,10 @@
 #pragma once
 
 #include "info_request.h"
+#include "latency_histogram.h"
 #include "cn105_state.h"
-#include <vector>
+#include <cstddef>
 #include <functional>
-#include <string>
 
 namespace devicestate {
 
@@ -16,9 +16,14 @@ namespace devicestate {
      *
      * This class extracts the INFO request management logic from the CN105State component
      * to respect the single responsibility principle (SRP).
+     *
+     * Requests live in a fixed array indexed by code, so a polling cycle runs
+     * without heap allocation and every lookup by code is O(1).
      */
     class RequestScheduler {
     public:
+        static const uint8_t MAX_REQUESTS = 8;
+
         /**
          * @brief Callback type for sending a packet
          * @param code The request code to send
@@ -27,11 +32,11 @@ namespace devicestate {
 
         /**
          * @brief Callback type for timeout management
-         * @param name Unique timeout name
+         * @param name Unique timeout name (static storage, it is not copied)
          * @param timeout_ms Timeout duration in milliseconds
          * @param callback Function to call when timeout expires
          */
-        using TimeoutCallback = std::function<void(const std::string&, uint32_t, std::function<void()>)>;
+        using TimeoutCallback = std::function<void(const char*, uint32_t, std::function<void()>)>;
 
         /**
          * @brief Callback type for terminating a cycle
@@ -59,10 +64,11 @@ namespace devicestate {
         );
 
         /**
-         * @brief Registers a request in the queue
-         * @param req The request to register (non-const reference to allow modification)
+         * @brief Registers a request in the queue (copied into its slot)
+         * @param req The request to register
+         * @return false if the queue is full or the code is already registered
          */
-        void register_request(InfoRequest& req);
+        bool register_request(const InfoRequest& req);
 
         /**
          * @brief Clears the request list
@@ -88,6 +94,13 @@ namespace devicestate {
          */
         void send_next_after(uint8_t previous_code, CN105State* context = nullptr);
 
+        /**
+         * @brief Restarts the round-trip clock of an awaited request when its frame is transmitted,
+         * so the latency leaves out the time spent in the transmit queue
+         * @param code The code of the request that went on the wire
+         */
+        void mark_sent(uint8_t code);
+
         /**
          * @brief Marks a response as received for a given code and calls the onResponse callback if present
          * @param code The code of the request whose response was received
@@ -103,6 +116,54 @@ namespace devicestate {
          */
         bool process_response(uint8_t code, CN105State* context = nullptr);
 
+        /**
+         * @brief Processes a received response and feeds its payload to adaptive polling
+         * @param code The code of the received response
+         * @param payload Response payload (can be nullptr)
+         * @param length Payload length in bytes
+         * @param context CN105State context to call onResponse (can be nullptr, uses context_callback_ if provided)
+         * @return true if the response was processed, false otherwise
+         */
+        bool process_response(uint8_t code, const uint8_t* payload, size_t length, CN105State* context = nullptr);
+
+        /**
+         * @brief Same as process_response() without sending the next request: the caller decides
+         * when the cycle goes on with send_next_after(code)
+         * @return true if the response was processed, false otherwise
+         */
+        bool receive_response(uint8_t code, const uint8_t* payload, size_t length, CN105State* context = nullptr);
+
+        /**
+         * @brief Enables adaptive polling: the interval of each request moves within [min_interval_ms, max_interval_ms],
+         * back to min_interval_ms when its payload changes, doubled while the payload stays identical
+         * @param min_interval_ms Lower bound (0: every cycle)
+         * @param max_interval_ms Upper bound, 0 disables adaptive polling
+         */
+        void set_adaptive_polling(uint32_t min_interval_ms, uint32_t max_interval_ms);
+
+        /**
+         * @brief Makes a request due on the next cycle (e.g. after a write that should change its payload)
+         * @param code The code of the request
+         */
+        void expedite(uint8_t code);
+
+        /**
+         * @brief Makes every request due on the next cycle (e.g. after a reconnection)
+         */
+        void expedite_all();
+
+        /**
+         * @brief Logs the round-trip histogram of every request that got an answer
+         * @param tag Log tag to use
+         */
+        void log_latency(const char* tag) const;
+
+        /**
+         * @brief Adds the round-trip histograms of all requests into one
+         * @param into Histogram receiving the samples
+         */
+        void merge_latency(LatencyHistogram& into) const;
+
         /**
          * @brief Method to call in the main loop to manage timeouts
          * Note: Timeout management is currently handled via callbacks,
@@ -111,8 +172,12 @@ namespace devicestate {
         void loop();
 
     private:
-        std::vector<InfoRequest> requests_;          // Request queue
+        InfoRequest requests_[MAX_REQUESTS];          // Request queue, in registration order
+        uint8_t request_count_;                       // Used slots of requests_
+        int8_t slot_by_code_[256];                    // Code -> index in requests_, -1 when not registered
         int current_request_index_;                  // Current request index
+        uint32_t adaptive_min_ms_;                    // Adaptive polling bounds, adaptive_max_ms_ == 0 when disabled
+        uint32_t adaptive_max_ms_;
         SendCallback send_callback_;                  // Callback to send a packet
         TimeoutCallback timeout_callback_;            // Callback for timeout management
         TerminateCallback terminate_callback_;        // Callback to terminate a cycle
@@ -124,6 +189,17 @@ namespace devicestate {
          * @param context CN105State context to check canSend (can be nullptr)
          */
         void send_request(uint8_t code, CN105State* context = nullptr);
+
+        /**
+         * @brief Finds the request registered for a code
+         * @return The request, nullptr if the code is not registered
+         */
+        InfoRequest* find_request(uint8_t code);
+
+        /**
+         * @brief Shortens or backs off the adaptive interval of a request from its new payload
+         */
+        void adapt_interval(InfoRequest& req, const uint8_t* payload, size_t length);
     };
 
 }
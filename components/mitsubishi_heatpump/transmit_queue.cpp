@@ -0,0 +1,146 @@
+#include "transmit_queue.h"
+
+#include <cstring>
+
+#include "esphome.h"
+
+namespace devicestate {
+
+    static const char* TAG = "TransmitQueue"; // Logging tag
+
+    TxPriority TransmitQueue::classify(const uint8_t* packet, int length) {
+        if (length < 6) {
+            return TxPriority_Info;
+        }
+        switch (packet[1]) {
+        case 0x5A:
+        case 0x5B:
+            return TxPriority_Connect;
+        case 0x41:
+            return (packet[5] == 0x07) ? TxPriority_RemoteTemp : TxPriority_Control;
+        default:
+            return TxPriority_Info;
+        }
+    }
+
+    int TransmitQueue::findDuplicate(const uint8_t* packet, TxPriority priority) const {
+        if (priority != TxPriority_RemoteTemp && priority != TxPriority_Info) {
+            return -1;
+        }
+        for (int i = 0; i < TX_QUEUE_CAPACITY; i++) {
+            if (used_[i] && slots_[i].priority == priority &&
+                    slots_[i].packet[1] == packet[1] && slots_[i].packet[5] == packet[5]) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int TransmitQueue::findEvictable(TxPriority priority) const {
+        // oldest frame of the lowest priority class, only if it is less important than the new one
+        int candidate = -1;
+        for (int i = 0; i < TX_QUEUE_CAPACITY; i++) {
+            if (!used_[i] || slots_[i].priority <= priority) continue;
+            if (candidate < 0 || slots_[i].priority > slots_[candidate].priority ||
+                    (slots_[i].priority == slots_[candidate].priority &&
+                        static_cast<int32_t>(slots_[i].sequence - slots_[candidate].sequence) < 0)) {
+                candidate = i;
+            }
+        }
+        return candidate;
+    }
+
+    bool TransmitQueue::push(const uint8_t* packet, int length, bool checkIsActive) {
+        if (length <= 0 || length > PACKET_LEN) {
+            ESP_LOGE(TAG, "Packet length %d exceeds PACKET_LEN %d, dropping.", length, PACKET_LEN);
+            return false;
+        }
+
+        const TxPriority priority = classify(packet, length);
+        int slot = this->findDuplicate(packet, priority);
+        if (slot >= 0) {
+            // keep the queue position of the frame being replaced, only the content is refreshed
+            ESP_LOGD(TAG, "replacing queued frame %02X/%02X with a newer one", packet[1], packet[5]);
+            memcpy(slots_[slot].packet, packet, static_cast<size_t>(length));
+            slots_[slot].length = static_cast<uint8_t>(length);
+            slots_[slot].checkIsActive = checkIsActive;
+            return true;
+        }
+
+        for (int i = 0; i < TX_QUEUE_CAPACITY && slot < 0; i++) {
+            if (!used_[i]) slot = i;
+        }
+        if (slot < 0) {
+            slot = this->findEvictable(priority);
+            if (slot < 0) {
+                ESP_LOGW(TAG, "queue full, dropping frame %02X/%02X", packet[1], packet[5]);
+                return false;
+            }
+            ESP_LOGW(TAG, "queue full, evicting frame %02X/%02X", slots_[slot].packet[1], slots_[slot].packet[5]);
+        }
+
+        memcpy(slots_[slot].packet, packet, static_cast<size_t>(length));
+        slots_[slot].length = static_cast<uint8_t>(length);
+        slots_[slot].priority = priority;
+        slots_[slot].checkIsActive = checkIsActive;
+        slots_[slot].sequence = nextSequence_++;
+        used_[slot] = true;
+        return true;
+    }
+
+    int TransmitQueue::nextIndex() const {
+        int next = -1;
+        for (int i = 0; i < TX_QUEUE_CAPACITY; i++) {
+            if (!used_[i]) continue;
+            if (next < 0 || slots_[i].priority < slots_[next].priority ||
+                    (slots_[i].priority == slots_[next].priority &&
+                        static_cast<int32_t>(slots_[i].sequence - slots_[next].sequence) < 0)) {
+                next = i;
+            }
+        }
+        return next;
+    }
+
+    const QueuedPacket* TransmitQueue::peek() const {
+        const int next = this->nextIndex();
+        return (next < 0) ? nullptr : &slots_[next];
+    }
+
+    bool TransmitQueue::pop(QueuedPacket& out) {
+        const int next = this->nextIndex();
+        if (next < 0) {
+            return false;
+        }
+        out = slots_[next];
+        used_[next] = false;
+        return true;
+    }
+
+    bool TransmitQueue::contains(uint8_t command, uint8_t code) const {
+        for (int i = 0; i < TX_QUEUE_CAPACITY; i++) {
+            if (used_[i] && slots_[i].packet[1] == command && slots_[i].packet[5] == code) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool TransmitQueue::isEmpty() const {
+        return this->size() == 0;
+    }
+
+    int TransmitQueue::size() const {
+        int count = 0;
+        for (int i = 0; i < TX_QUEUE_CAPACITY; i++) {
+            if (used_[i]) count++;
+        }
+        return count;
+    }
+
+    void TransmitQueue::clear() {
+        for (int i = 0; i < TX_QUEUE_CAPACITY; i++) {
+            used_[i] = false;
+        }
+    }
+
+}
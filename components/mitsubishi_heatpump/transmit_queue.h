@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cn105_types.h"
+
+namespace devicestate {
+
+    static const int TX_QUEUE_CAPACITY = 6;
+
+    /**
+     * Transmit priority classes, lower value is sent first.
+     */
+    enum TxPriority : uint8_t {
+        TxPriority_Connect = 0,       // 0x5A/0x5B handshake
+        TxPriority_Control = 1,       // 0x41 set packets (settings, run states)
+        TxPriority_RemoteTemp = 2,    // 0x41/0x07 remote temperature
+        TxPriority_Info = 3           // 0x42 info polls
+    };
+
+    struct QueuedPacket {
+        uint8_t packet[PACKET_LEN];
+        uint8_t length;
+        TxPriority priority;
+        bool checkIsActive;
+        uint32_t sequence;            // insertion order, FIFO inside a priority class
+    };
+
+    /**
+     * @class TransmitQueue
+     * @brief Fixed-capacity prioritised queue of frames waiting for the CN105 link.
+     *
+     * No heap allocation: frames are copied in a static array of slots.
+     * Remote temperature and info frames are deduplicated by frame type (only the
+     * newest one is kept); control frames only carry the fields that changed, so
+     * they are never merged and keep their FIFO order.
+     */
+    class TransmitQueue {
+    public:
+        static TxPriority classify(const uint8_t* packet, int length);
+
+        /**
+         * @brief Queues a copy of the frame
+         * @return false if the frame was dropped (invalid length or queue full of higher priority frames)
+         */
+        bool push(const uint8_t* packet, int length, bool checkIsActive);
+
+        /**
+         * @brief Returns the next frame to send (highest priority, oldest first) or nullptr
+         */
+        const QueuedPacket* peek() const;
+
+        /**
+         * @brief Removes the next frame to send and copies it into out
+         */
+        bool pop(QueuedPacket& out);
+
+        // a frame with that command and code byte (packet[1], packet[5]) is waiting
+        bool contains(uint8_t command, uint8_t code) const;
+        bool isEmpty() const;
+        int size() const;
+        void clear();
+
+    private:
+        QueuedPacket slots_[TX_QUEUE_CAPACITY];
+        bool used_[TX_QUEUE_CAPACITY] = {};
+        uint32_t nextSequence_ = 0;
+
+        int nextIndex() const;
+        int findDuplicate(const uint8_t* packet, TxPriority priority) const;
+        int findEvictable(TxPriority priority) const;
+    };
+
+}
@@ -39,6 +39,10 @@ namespace devicestate {
             uart_->write_byte(bytes);
         }
 
+        void write_array(const uint8_t *data, size_t len) override {
+            uart_->write_array(data, len);
+        }
+
         int available() override {
             return uart_->available();
         }
@@ -46,6 +50,13 @@ namespace devicestate {
         bool read(uint8_t *data) override {
             return uart_->read_byte(data);
         }
+
+        size_t read_array(uint8_t *data, size_t len) override {
+            if (len == 0 || !uart_->read_array(data, len)) {
+                return 0;
+            }
+            return len;
+        }
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "write_tracker.h"
+
+#include <cstring>
+
+#include "esphome.h"
+
+namespace devicestate {
+
+    static const char* TAG = "WriteTracker"; // Logging tag
+
+    WriteType WriteTracker::classify(const uint8_t* packet, int length) {
+        if (length < 6 || packet[1] != 0x41) {
+            return WriteType_Count;
+        }
+        switch (packet[5]) {
+        case 0x01:
+            return WriteType_Settings;
+        case 0x08:
+            return WriteType_RunStates;
+        case 0x07:
+            return WriteType_RemoteTemp;
+        default:
+            return WriteType_Other;
+        }
+    }
+
+    const char* WriteTracker::nameOf(WriteType type) {
+        switch (type) {
+        case WriteType_Settings: return "Settings write (0x41/0x01)";
+        case WriteType_RunStates: return "Run states write (0x41/0x08)";
+        case WriteType_RemoteTemp: return "Remote temperature (0x41/0x07)";
+        case WriteType_Other: return "Other write (0x41)";
+        default: return "none";
+        }
+    }
+
+    void WriteTracker::onSent(const uint8_t* packet, int length, uint32_t now_ms) {
+        const WriteType type = classify(packet, length);
+        if (type == WriteType_Count) {
+            return;
+        }
+        if (this->count_ == WRITE_TRACKER_CAPACITY) {
+            // cannot happen while writes wait for their ack, but never lose track of the newest one
+            ESP_LOGW(TAG, "%s: too many writes in flight, forgetting the oldest", nameOf(type));
+            this->markLost(this->writes_[this->head_].type);
+            this->popOldest();
+        }
+
+        InFlightWrite& slot = this->writes_[(this->head_ + this->count_) % WRITE_TRACKER_CAPACITY];
+        const int copied = length < PACKET_LEN ? length : PACKET_LEN;
+        memcpy(slot.packet, packet, copied);
+        slot.length = static_cast<uint8_t>(copied);
+        slot.type = type;
+        slot.attempt = this->nextAttempt_[type];
+        slot.sentMs = now_ms;
+        this->count_++;
+
+        this->nextAttempt_[type] = 0;
+        this->stats_[type].sent++;
+    }
+
+    bool WriteTracker::onAck(uint32_t now_ms, WriteType* type) {
+        if (this->count_ == 0) {
+            return false;
+        }
+        const InFlightWrite& oldest = this->writes_[this->head_];
+        WriteStats& stats = this->stats_[oldest.type];
+        stats.acked++;
+        stats.ackLatency.record(now_ms - oldest.sentMs);
+        if (type != nullptr) {
+            *type = oldest.type;
+        }
+        this->popOldest();
+        return true;
+    }
+
+    bool WriteTracker::expire(uint32_t now_ms, uint32_t timeout_ms, InFlightWrite& out) {
+        if (this->count_ == 0 || now_ms - this->writes_[this->head_].sentMs <= timeout_ms) {
+            return false;
+        }
+        out = this->writes_[this->head_];
+        this->popOldest();
+        return true;
+    }
+
+    void WriteTracker::markRetransmit(WriteType type, uint8_t attempt) {
+        this->nextAttempt_[type] = attempt;
+        this->stats_[type].retransmitted++;
+    }
+
+    void WriteTracker::markLost(WriteType type) {
+        this->stats_[type].lost++;
+    }
+
+    bool WriteTracker::hasPending(WriteType type) const {
+        for (int i = 0; i < this->count_; i++) {
+            if (this->writes_[(this->head_ + i) % WRITE_TRACKER_CAPACITY].type == type) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WriteTracker::clear() {
+        this->head_ = 0;
+        this->count_ = 0;
+        memset(this->nextAttempt_, 0, sizeof(this->nextAttempt_));
+    }
+
+    void WriteTracker::popOldest() {
+        this->head_ = (this->head_ + 1) % WRITE_TRACKER_CAPACITY;
+        this->count_--;
+    }
+
+}
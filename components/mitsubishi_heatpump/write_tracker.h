@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cn105_types.h"
+#include "latency_histogram.h"
+
+namespace devicestate {
+
+    static const int WRITE_TRACKER_CAPACITY = 4;
+
+    /**
+     * Kinds of 0x41 set packets, each acknowledged by a 0x61.
+     */
+    enum WriteType : uint8_t {
+        WriteType_Settings = 0,       // 0x41/0x01 wanted settings
+        WriteType_RunStates,          // 0x41/0x08 wanted run states
+        WriteType_RemoteTemp,         // 0x41/0x07 remote temperature
+        WriteType_Other,              // other 0x41 codes
+        WriteType_Count
+    };
+
+    /**
+     * A write sent to the heatpump and not acknowledged yet, with a copy of the
+     * frame so it can be sent again if its ack never comes.
+     */
+    struct InFlightWrite {
+        uint8_t packet[PACKET_LEN];
+        uint8_t length;
+        WriteType type;
+        uint8_t attempt;              // 0 for the first transmission
+        uint32_t sentMs;
+    };
+
+    struct WriteStats {
+        uint32_t sent = 0;
+        uint32_t acked = 0;
+        uint32_t retransmitted = 0;
+        uint32_t lost = 0;            // given up after the last retransmission, or superseded
+        LatencyHistogram ackLatency;
+    };
+
+    /**
+     * @class WriteTracker
+     * @brief Table of the writes waiting for their 0x61 ack.
+     *
+     * The ack does not say which write it answers, but the heatpump answers in
+     * order: acks are matched to the oldest write in flight. A write without ack
+     * after the timeout is expired and handed back to the caller, which decides
+     * to send it again. Fixed capacity, no allocation.
+     */
+    class WriteTracker {
+    public:
+        // WriteType_Count when the frame is not a set packet
+        static WriteType classify(const uint8_t* packet, int length);
+        static const char* nameOf(WriteType type);
+
+        void onSent(const uint8_t* packet, int length, uint32_t now_ms);
+
+        /**
+         * @brief Matches an ack to the oldest write in flight and records its round-trip
+         * @return false for an ack nothing was waiting for
+         */
+        bool onAck(uint32_t now_ms, WriteType* type = nullptr);
+
+        /**
+         * @brief Removes the oldest write older than timeout_ms
+         * @return true with the write copied into out, false when none has expired
+         */
+        bool expire(uint32_t now_ms, uint32_t timeout_ms, InFlightWrite& out);
+
+        // the next frame of that type sent is attempt number `attempt` of an expired write
+        void markRetransmit(WriteType type, uint8_t attempt);
+        void markLost(WriteType type);
+
+        bool hasPending(WriteType type) const;
+        int size() const { return this->count_; }
+        // forgets the writes in flight, counters are kept
+        void clear();
+
+        const WriteStats& getStats(WriteType type) const { return this->stats_[type]; }
+
+    private:
+        InFlightWrite writes_[WRITE_TRACKER_CAPACITY];
+        int head_ = 0;                // oldest write
+        int count_ = 0;
+        uint8_t nextAttempt_[WriteType_Count] = {};
+        WriteStats stats_[WriteType_Count];
+
+        void popOldest();
+    };
+
+}
@@ -0,0 +1,481 @@
+/**
+ * cn105_bench
+ *
+ * Microbenchmarks of the CN105 decode/encode hot paths, on the host build:
+ * stream decoding through CN105Connection::processInput (bulk and per-byte,
+ * clean and noisy streams), checkSum, CN105Protocol::createPacket, the
+ * settings/status parsers, the lookupByteMap* helpers and one polling cycle
+ * through the RequestScheduler. Each line reports
+ * ns/op, allocations and allocated bytes per op, and bytes/s and frames/s for
+ * the stream benchmarks, so the numbers can be tracked across releases.
+ * Exits with 1 when a processInput benchmark allocates.
+ *
+ * usage: cn105_bench [--filter <substring>] [--min-time <ms>] [--log-level <0..7>]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "cn105_connection.h"
+#include "cn105_protocol.h"
+#include "cn105_state.h"
+#include "cn105_utils.h"
+#include "remote_temp_filter.h"
+#include "request_scheduler.h"
+
+#include "esphome.h"
+
+// every heap allocation of the process is counted, benchmarks read the delta
+namespace {
+    uint64_t allocCount = 0;
+    uint64_t allocBytes = 0;
+}
+
+void* operator new(size_t size) {
+    allocCount++;
+    allocBytes += size;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+    using BenchClock = std::chrono::steady_clock;
+
+    // keeps the compiler from optimizing away a result
+    template <typename T>
+    inline void keep(T const& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    struct Options {
+        const char* filter = nullptr;
+        uint32_t min_time_ms = 200;
+    };
+
+    struct Result {
+        uint64_t ops = 0;
+        double seconds = 0;
+        uint64_t allocs = 0;
+        uint64_t allocBytes = 0;
+    };
+
+    /**
+     * Runs body() in growing batches until min_time_ms of wall time is spent,
+     * after one warm-up call.
+     */
+    template <typename F>
+    Result measure(const Options& options, F&& body) {
+        body();
+
+        Result result;
+        uint64_t batch = 1;
+        const double minSeconds = options.min_time_ms / 1000.0;
+        while (result.seconds < minSeconds) {
+            const uint64_t allocsBefore = allocCount;
+            const uint64_t bytesBefore = allocBytes;
+            const auto start = BenchClock::now();
+            for (uint64_t i = 0; i < batch; i++) {
+                body();
+            }
+            const auto stop = BenchClock::now();
+            result.allocs += allocCount - allocsBefore;
+            result.allocBytes += allocBytes - bytesBefore;
+            result.seconds += std::chrono::duration<double>(stop - start).count();
+            result.ops += batch;
+            if (batch < (1u << 20)) {
+                batch *= 2;
+            }
+        }
+        return result;
+    }
+
+    bool selected(const Options& options, const char* name) {
+        return options.filter == nullptr || std::strstr(name, options.filter) != nullptr;
+    }
+
+    void printHeader() {
+        std::printf("%-32s %12s %12s %10s %10s %12s %12s\n",
+            "benchmark", "ns/op", "ops/s", "allocs/op", "B/op", "MB/s", "frames/s");
+    }
+
+    // bytesPerOp/framesPerOp are 0 for benchmarks that do not decode a stream
+    void printResult(const char* name, const Result& r, uint64_t bytesPerOp = 0, uint64_t framesPerOp = 0) {
+        const double ops = static_cast<double>(r.ops);
+        const double opsPerSecond = ops / r.seconds;
+        char mbps[16] = "-";
+        char fps[16] = "-";
+        if (bytesPerOp > 0) {
+            std::snprintf(mbps, sizeof(mbps), "%.2f", opsPerSecond * bytesPerOp / 1e6);
+            std::snprintf(fps, sizeof(fps), "%.0f", opsPerSecond * framesPerOp);
+        }
+        std::printf("%-32s %12.1f %12.0f %10.2f %10.1f %12s %12s\n",
+            name, r.seconds * 1e9 / ops, opsPerSecond, r.allocs / ops, r.allocBytes / ops, mbps, fps);
+    }
+
+    /**
+     * IIODevice serving a byte stream, again from the start on every rewind().
+     * With bulk == false read_array() fails, so processInput() takes the
+     * per-byte parse() path.
+     */
+    class StreamIODevice : public devicestate::IIODevice {
+    public:
+        explicit StreamIODevice(bool bulk) : bulk_(bulk) {}
+
+        bool begin() override { return true; }
+        void write(uint8_t) override {}
+        int available() override { return static_cast<int>(this->stream_->size() - this->pos_); }
+
+        bool read(uint8_t* byte) override {
+            if (this->pos_ >= this->stream_->size()) {
+                return false;
+            }
+            *byte = (*this->stream_)[this->pos_++];
+            return true;
+        }
+
+        size_t read_array(uint8_t* data, size_t len) override {
+            if (!this->bulk_) {
+                return 0;
+            }
+            const size_t count = std::min(len, this->stream_->size() - this->pos_);
+            std::memcpy(data, this->stream_->data() + this->pos_, count);
+            this->pos_ += count;
+            return count;
+        }
+
+        void setStream(const std::vector<uint8_t>& stream) {
+            this->stream_ = &stream;
+            this->pos_ = 0;
+        }
+
+        void rewind() { this->pos_ = 0; }
+
+    private:
+        const std::vector<uint8_t>* stream_ = nullptr;
+        bool bulk_;
+        size_t pos_ = 0;
+    };
+
+    void appendFrame(std::vector<uint8_t>& stream, uint8_t command, const uint8_t* data, uint8_t dataLength) {
+        const size_t start = stream.size();
+        const uint8_t header[5] = { 0xFC, command, 0x01, 0x30, dataLength };
+        stream.insert(stream.end(), header, header + 5);
+        stream.insert(stream.end(), data, data + dataLength);
+        stream.push_back(devicestate::checkSum(stream.data() + start, 5 + dataLength));
+    }
+
+    // reply payloads of a connected unit: heating at 21.5°C, room 20.5°C, compressor running
+    const uint8_t SETTINGS_0x02[16] = { 0x02, 0x00, 0x00, 0x01, 0x01, 0x09, 0x00, 0x00, 0x00, 0x00, 0x03, 0xAB, 0x00, 0x00, 0x00, 0x00 };
+    const uint8_t ROOM_0x03[16] = { 0x03, 0x00, 0x00, 0x0A, 0x00, 0x90, 0xA9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x34, 0x00, 0x00 };
+    const uint8_t STATUS_0x06[16] = { 0x06, 0x00, 0x00, 0x2A, 0x01, 0x02, 0x58, 0x04, 0xD2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    const uint8_t STANDBY_0x09[16] = { 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    const uint8_t ACK_0x61[16] = { 0x00 };
+
+    struct Stream {
+        std::vector<uint8_t> bytes;
+        uint64_t frames = 0;            // frames with a valid checksum
+    };
+
+    // one polling cycle (0x02, 0x03, 0x06, 0x09 and a write ack) repeated
+    Stream buildCleanStream(int cycles) {
+        Stream result;
+        std::vector<uint8_t>& stream = result.bytes;
+        for (int i = 0; i < cycles; i++) {
+            appendFrame(stream, 0x62, SETTINGS_0x02, 16);
+            appendFrame(stream, 0x62, ROOM_0x03, 16);
+            appendFrame(stream, 0x62, STATUS_0x06, 16);
+            appendFrame(stream, 0x62, STANDBY_0x09, 16);
+            appendFrame(stream, 0x61, ACK_0x61, 16);
+            result.frames += 5;
+        }
+        return result;
+    }
+
+    // same cycle with line noise between frames (including stray 0xFC) and one frame in 8 with a bad checksum
+    Stream buildNoisyStream(int cycles) {
+        Stream result;
+        std::vector<uint8_t>& stream = result.bytes;
+        uint32_t seed = 0x2545F491;
+        auto random = [&seed]() {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        };
+        const uint8_t* payloads[4] = { SETTINGS_0x02, ROOM_0x03, STATUS_0x06, STANDBY_0x09 };
+        int frame = 0;
+        for (int i = 0; i < cycles; i++) {
+            for (int j = 0; j < 5; j++) {
+                const int noise = random() % 6;
+                for (int n = 0; n < noise; n++) {
+                    stream.push_back((random() % 4 == 0) ? 0xFC : static_cast<uint8_t>(random()));
+                }
+                if (j < 4) {
+                    appendFrame(stream, 0x62, payloads[j], 16);
+                } else {
+                    appendFrame(stream, 0x61, ACK_0x61, 16);
+                }
+                if (++frame % 8 == 0) {
+                    stream.back() ^= 0x01;
+                } else {
+                    result.frames++;
+                }
+            }
+        }
+        // a clean frame at the end leaves the decoder idle between passes
+        appendFrame(stream, 0x61, ACK_0x61, 16);
+        result.frames++;
+        return result;
+    }
+
+    // false when decoding the stream allocated: steady-state polling must not touch the heap
+    bool benchStream(const Options& options, const char* name, const Stream& stream, bool bulk) {
+        if (!selected(options, name)) {
+            return true;
+        }
+        StreamIODevice device(bulk);
+        devicestate::CN105Connection connection(
+            &device,
+            [](const std::string&, uint32_t, std::function<void()>) {},
+            [](bool) {},
+            2000);
+
+        const devicestate::CN105Connection::PacketCallback callback = [](const uint8_t* data, const int) { keep(data); };
+
+        // steady state: connected, so no handshake logging on every frame
+        std::vector<uint8_t> connectReply;
+        const uint8_t connectData[1] = { 0x00 };
+        appendFrame(connectReply, 0x7A, connectData, 1);
+        device.setStream(connectReply);
+        connection.processInput(callback);
+
+        device.setStream(stream.bytes);
+        const Result r = measure(options, [&]() {
+            device.rewind();
+            connection.processInput(callback);
+        });
+        printResult(name, r, stream.bytes.size(), stream.frames);
+        if (r.allocs > 0) {
+            std::fprintf(stderr, "%s: %.2f allocations per op, expected none\n", name,
+                static_cast<double>(r.allocs) / static_cast<double>(r.ops));
+            return false;
+        }
+        return true;
+    }
+
+    void benchCodec(const Options& options) {
+        devicestate::CN105Protocol protocol;
+        devicestate::CN105State state;
+
+        if (selected(options, "checkSum")) {
+            uint8_t packet[PACKET_LEN];
+            std::memcpy(packet, HEADER, HEADER_LEN);
+            std::memset(packet + HEADER_LEN, 0x5A, PACKET_LEN - HEADER_LEN);
+            const Result r = measure(options, [&]() {
+                uint8_t sum = devicestate::checkSum(packet, PACKET_LEN - 1);
+                keep(sum);
+            });
+            printResult("checkSum", r);
+        }
+
+        if (selected(options, "createPacket")) {
+            // every field wanted: the longest path through the encoder
+            state.setPowerSetting(true);
+            state.setModeSetting(ModeSetting_Cool);
+            state.setTemperature(22.5f);
+            state.setFanSpeed(FanSetting_Speed3);
+            state.setVaneSetting(VaneSetting_Swing);
+            state.setWideVaneSetting(WideVaneSetting_Center);
+            wantedHeatpumpSettings wanted;
+            uint32_t sequence;
+            state.snapshotWantedSettings(wanted, sequence);
+            uint8_t packet[PACKET_LEN];
+            const Result r = measure(options, [&]() {
+                protocol.createPacket(packet, state, wanted);
+                keep(packet);
+            });
+            printResult("createPacket", r);
+            state.resetWantedSettings();
+        }
+
+        // parsers see the same payload on every poll in steady state, like on a real unit
+        uint8_t payload[16];
+        if (selected(options, "parseSettings0x02")) {
+            std::memcpy(payload, SETTINGS_0x02, sizeof(payload));
+            const Result r = measure(options, [&]() { protocol.parseSettings0x02(payload, state); });
+            printResult("parseSettings0x02", r);
+        }
+        if (selected(options, "parseStatus0x03")) {
+            std::memcpy(payload, ROOM_0x03, sizeof(payload));
+            const Result r = measure(options, [&]() { protocol.parseStatus0x03(payload, state); });
+            printResult("parseStatus0x03", r);
+        }
+        if (selected(options, "parseStatus0x06")) {
+            std::memcpy(payload, STATUS_0x06, sizeof(payload));
+            const Result r = measure(options, [&]() { protocol.parseStatus0x06(payload, state); });
+            printResult("parseStatus0x06", r);
+        }
+    }
+
+    void benchLookups(const Options& options) {
+        // last entries of the maps: worst case of the linear scans
+        volatile uint8_t wideVaneByte = WIDEVANE[7];
+        volatile uint8_t tempByte = TEMP[15];
+        volatile int temperature = 16;
+        const char* volatile wideVaneName = WIDEVANE_MAP[7];
+        const std::string fanName = FAN_MAP[5];   // a copy: strcmp cannot stop at pointer equality
+
+        if (selected(options, "lookupByteMapValue/str")) {
+            const Result r = measure(options, [&]() {
+                const char* value = lookupByteMapValue(WIDEVANE_MAP, WIDEVANE_INDEX, wideVaneByte, "bench");
+                keep(value);
+            });
+            printResult("lookupByteMapValue/str", r);
+        }
+        if (selected(options, "lookupByteMapValue/int")) {
+            const Result r = measure(options, [&]() {
+                int value = lookupByteMapValue(TEMP_MAP, TEMP_INDEX, tempByte, "bench");
+                keep(value);
+            });
+            printResult("lookupByteMapValue/int", r);
+        }
+        if (selected(options, "lookupByteMapIndex/str")) {
+            const Result r = measure(options, [&]() {
+                int index = lookupByteMapIndex(WIDEVANE_MAP, 8, wideVaneName, "bench");
+                keep(index);
+            });
+            printResult("lookupByteMapIndex/str", r);
+        }
+        if (selected(options, "lookupByteMapIndex/str-copy")) {
+            const Result r = measure(options, [&]() {
+                int index = lookupByteMapIndex(FAN_MAP, 6, fanName.c_str(), "bench");
+                keep(index);
+            });
+            printResult("lookupByteMapIndex/str-copy", r);
+        }
+        if (selected(options, "lookupByteMapIndex/int")) {
+            const Result r = measure(options, [&]() {
+                int index = lookupByteMapIndex(TEMP_MAP_INDEX, temperature, "bench");
+                keep(index);
+            });
+            printResult("lookupByteMapIndex/int", r);
+        }
+    }
+
+    void benchScheduler(const Options& options) {
+        if (!selected(options, "scheduler/cycle")) {
+            return;
+        }
+
+        // the request set of CN105ControlFlow::registerInfoRequests(), without the parsers
+        devicestate::CN105State state;
+        uint8_t sent = 0;
+        bool terminated = false;
+        devicestate::RequestScheduler scheduler(
+            [&sent](uint8_t code) { sent = code; },
+            [](const char* name, uint32_t timeout_ms, std::function<void()> callback) { keep(name); },
+            [&terminated]() { terminated = true; },
+            [&state]() -> devicestate::CN105State* { return &state; });
+        scheduler.register_request(devicestate::InfoRequest("settings", "Settings", 0x02, 3, 0));
+        scheduler.register_request(devicestate::InfoRequest("room_temp", "Room temperature", 0x03, 3, 0));
+        scheduler.register_request(devicestate::InfoRequest("status", "Status", 0x06, 3, 0));
+        scheduler.register_request(devicestate::InfoRequest("standby", "Power/Standby", 0x09, 3, 500));
+        devicestate::InfoRequest hvacOptions("hvac_options", "HVAC options", 0x42, 3, 500);
+        hvacOptions.disabled = true;
+        scheduler.register_request(hvacOptions);
+
+        // one op: start a cycle and answer every request until the scheduler terminates it
+        const Result r = measure(options, [&]() {
+            terminated = false;
+            scheduler.send_next_after(0x00);
+            while (!terminated) {
+                scheduler.process_response(sent);
+            }
+        });
+        printResult("scheduler/cycle", r);
+    }
+
+
+    void benchRemoteTempFilter(const Options& options) {
+        if (!selected(options, "remoteTempFilter/push")) {
+            return;
+        }
+
+        // full pipeline on a widest window, samples jittering around 21.5 with a spike now and then
+        devicestate::RemoteTempFilter filter;
+        filter.configure(devicestate::REMOTE_TEMP_FILTER_MAX_WINDOW, 3.0f, 0.5f, 0.1f);
+        static const float SAMPLES[8] = { 21.4f, 21.6f, 21.5f, 21.7f, 27.0f, 21.5f, 21.3f, 21.6f };
+        uint8_t index = 0;
+        const Result r = measure(options, [&]() {
+            float out = 0;
+            bool forwarded = filter.push(SAMPLES[index++ % 8], out);
+            keep(forwarded);
+            keep(out);
+        });
+        printResult("remoteTempFilter/push", r);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    int logLevel = ESPHOME_LOG_LEVEL_NONE;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.min_time_ms = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            logLevel = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: cn105_bench [--filter <substring>] [--min-time <ms>] [--log-level <0..7>]\n");
+            return 2;
+        }
+    }
+    esphome::host::set_log_level(logLevel);
+
+    printHeader();
+
+    const Stream clean = buildCleanStream(16);
+    const Stream noisy = buildNoisyStream(16);
+    bool allocationFree = true;
+    allocationFree &= benchStream(options, "processInput/clean/bulk", clean, true);
+    allocationFree &= benchStream(options, "processInput/clean/byte", clean, false);
+    allocationFree &= benchStream(options, "processInput/noisy/bulk", noisy, true);
+    allocationFree &= benchStream(options, "processInput/noisy/byte", noisy, false);
+    benchCodec(options);
+    benchLookups(options);
+    benchScheduler(options);
+    benchRemoteTempFilter(options);
+
+    return allocationFree ? 0 : 1;
+}
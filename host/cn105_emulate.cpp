@@ -0,0 +1,249 @@
+/**
+ * cn105_emulate
+ *
+ * Closed-loop run of the CN105 core and DeviceStateManager against the
+ * software indoor unit, on the virtual clock. Prints connect time, cycle time,
+ * control latency and recovery time after an outage, so the numbers can be
+ * compared between changes.
+ *
+ * usage: cn105_emulate [--cycles <n>] [--update-interval <ms>] [--delay <ms>] [--jitter <ms>]
+ *                      [--drop <permille>] [--corrupt <permille>] [--slow <permille>] [--slow-delay <ms>]
+ *                      [--outage <ms>] [--min-poll-interval <ms>] [--max-poll-interval <ms>] [--fast-delta <tenths of °C>]
+ *                      [--dither-interval <ms>] [--seed <n>] [--log-level <0..7>]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "cn105_emulator.h"
+#include "devicestatemanager.h"
+#include "host_stack.h"
+#include "virtual_clock.h"
+
+#include "Globals.h"
+#include "esphome.h"
+
+namespace {
+
+    struct Sensors {
+        esphome::binary_sensor::BinarySensor internal_power_on;
+        esphome::binary_sensor::BinarySensor device_state_active;
+        esphome::sensor::Sensor device_set_point;
+        esphome::binary_sensor::BinarySensor device_status_operating;
+        esphome::sensor::Sensor device_status_current_temperature;
+        esphome::sensor::Sensor device_status_outside_temperature;
+        esphome::sensor::Sensor device_status_compressor_frequency;
+        esphome::sensor::Sensor device_status_input_power;
+        esphome::sensor::Sensor device_status_kwh;
+        esphome::sensor::Sensor device_status_runtime_hours;
+        esphome::sensor::Sensor pid_set_point_correction;
+
+        uint32_t publishCount() const {
+            return internal_power_on.publish_count + device_state_active.publish_count + device_set_point.publish_count +
+                device_status_operating.publish_count + device_status_current_temperature.publish_count +
+                device_status_outside_temperature.publish_count + device_status_compressor_frequency.publish_count +
+                device_status_input_power.publish_count + device_status_kwh.publish_count +
+                device_status_runtime_hours.publish_count + pid_set_point_correction.publish_count;
+        }
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: cn105_emulate [--cycles <n>] [--update-interval <ms>] [--delay <ms>] [--jitter <ms>]\n"
+            "                     [--drop <permille>] [--corrupt <permille>] [--slow <permille>] [--slow-delay <ms>]\n"
+            "                     [--outage <ms>] [--min-poll-interval <ms>] [--max-poll-interval <ms>] [--fast-delta <tenths of °C>]\n"
+            "                     [--dither-interval <ms>] [--publish-heartbeat <ms>] [--seed <n>] [--log-level <0..7>]\n");
+    }
+
+}
+
+int main(int argc, char** argv) {
+    host::EmulatorConfig emulatorConfig;
+    host::HostStackConfig stackConfig;
+    uint32_t cycles = 20;
+    uint32_t outage_ms = 20000;
+    uint32_t publish_heartbeat = devicestate::PUBLISH_HEARTBEAT_DEFAULT_MS;
+    int logLevel = ESPHOME_LOG_LEVEL_WARN;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        const uint32_t value = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        if (std::strcmp(arg, "--cycles") == 0) cycles = value;
+        else if (std::strcmp(arg, "--update-interval") == 0) stackConfig.update_interval = value;
+        else if (std::strcmp(arg, "--delay") == 0) emulatorConfig.response_delay_ms = value;
+        else if (std::strcmp(arg, "--jitter") == 0) emulatorConfig.jitter_ms = value;
+        else if (std::strcmp(arg, "--drop") == 0) emulatorConfig.drop_permille = static_cast<uint16_t>(value);
+        else if (std::strcmp(arg, "--corrupt") == 0) emulatorConfig.corrupt_permille = static_cast<uint16_t>(value);
+        else if (std::strcmp(arg, "--slow") == 0) emulatorConfig.slow_permille = static_cast<uint16_t>(value);
+        else if (std::strcmp(arg, "--slow-delay") == 0) emulatorConfig.slow_delay_ms = value;
+        else if (std::strcmp(arg, "--outage") == 0) outage_ms = value;
+        else if (std::strcmp(arg, "--min-poll-interval") == 0) stackConfig.min_poll_interval = value;
+        else if (std::strcmp(arg, "--max-poll-interval") == 0) stackConfig.max_poll_interval = value;
+        else if (std::strcmp(arg, "--fast-delta") == 0) stackConfig.remote_temp_fast_delta = value / 10.0f;
+        else if (std::strcmp(arg, "--dither-interval") == 0) stackConfig.remote_temp_dither_interval = value;
+        else if (std::strcmp(arg, "--publish-heartbeat") == 0) publish_heartbeat = value;
+        else if (std::strcmp(arg, "--seed") == 0) emulatorConfig.seed = value;
+        else if (std::strcmp(arg, "--log-level") == 0) logLevel = static_cast<int>(value);
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    esphome::host::set_log_level(logLevel);
+    host::VirtualClock& clock = host::VirtualClock::instance();
+    clock.reset();
+
+    host::EmulatorIODevice emulator(emulatorConfig);
+    host::HostStack stack(&emulator, stackConfig);
+    Sensors sensors;
+    devicestate::DeviceStateManager dsm(
+        &emulator, &stack.state(), 16.0f, 31.0f,
+        &sensors.internal_power_on, &sensors.device_state_active, &sensors.device_set_point,
+        &sensors.device_status_operating, &sensors.device_status_current_temperature,
+        &sensors.device_status_outside_temperature, &sensors.device_status_compressor_frequency,
+        &sensors.device_status_input_power, &sensors.device_status_kwh,
+        &sensors.device_status_runtime_hours, &sensors.pid_set_point_correction);
+    dsm.setPublishHeartbeat(publish_heartbeat);
+
+    // same as MitsubishiHeatPump::terminateCycle(), without the workflows
+    std::vector<uint32_t> cycleTimes;
+    stack.onCycleEnd = [&]() {
+        cycleTimes.push_back(stack.getLastCycleMs());
+        dsm.update();
+        if (dsm.isInitialized()) {
+            dsm.publish();
+        }
+    };
+
+    // same as the write confirmation callback of MitsubishiHeatPump::setup()
+    stack.onWriteConfirmed = [&](bool) {
+        if (dsm.isInitialized()) {
+            dsm.update();
+            dsm.publish();
+        }
+    };
+
+    bool ok = true;
+
+    // 1. handshake (includes the 10 s bootstrap grace delay of CN105Connection)
+    const bool connected = stack.runUntil([&]() { return stack.isConnected(); }, 60000);
+    const uint32_t connect_ms = clock.now();
+    ok &= connected;
+
+    // 2. steady state polling
+    const uint32_t cyclesStart = clock.now();
+    stack.runUntil([&]() { return cycleTimes.size() >= cycles; }, cycles * (stackConfig.update_interval * 3 + 2000));
+    const uint32_t steadyElapsed = clock.now() - cyclesStart;
+    ok &= cycleTimes.size() >= cycles;
+
+    // 3. control latency: new target until written to the unit, then until read back
+    const float wanted = dsm.getDeviceState().targetTemperature == 23.5f ? 22.0f : 23.5f;
+    const uint32_t writesBefore = emulator.getSettingsWrites();
+    const uint32_t controlStart = clock.now();
+    dsm.setTargetTemperature(wanted);
+    dsm.commit();
+    const bool written = stack.runUntil([&]() { return emulator.getSettingsWrites() > writesBefore; }, 30000);
+    const uint32_t write_ms = clock.now() - controlStart;
+    const bool confirmed = stack.runUntil([&]() { return dsm.getDeviceState().targetTemperature == wanted; }, 30000);
+    const uint32_t confirm_ms = clock.now() - controlStart;
+    ok &= written && confirmed;
+
+    // 4. the same while a polling cycle is running: the write should not wait for the end of the cycle
+    stack.runUntil([&]() { return stack.loopCycle().isCycleRunning(); }, 30000);
+    const float midCycleWanted = wanted == 23.5f ? 22.0f : 23.5f;
+    const uint32_t midCycleWritesBefore = emulator.getSettingsWrites();
+    const uint32_t midCycleStart = clock.now();
+    dsm.setTargetTemperature(midCycleWanted);
+    dsm.commit();
+    const bool midCycleWritten = stack.runUntil([&]() { return emulator.getSettingsWrites() > midCycleWritesBefore; }, 30000);
+    const uint32_t midCycle_ms = clock.now() - midCycleStart;
+    ok &= midCycleWritten;
+    stack.runUntil([&]() { return dsm.getDeviceState().targetTemperature == midCycleWanted; }, 30000);
+
+    // 5. a 2 °C jump of the remote temperature sensor early in a fresh polling cycle, until it reaches the unit
+    stack.runUntil([&]() { return !stack.loopCycle().isCycleRunning(); }, 30000);
+    stack.runUntil([&]() { return stack.loopCycle().isCycleRunning(); }, 30000);
+    stack.run(50);
+    const uint32_t remoteTempWritesBefore = emulator.getRemoteTempWrites();
+    const uint32_t remoteTempStart = clock.now();
+    stack.controlFlow().setRemoteTemperature(25.0f);
+    const bool remoteTempSent = stack.runUntil([&]() { return emulator.getRemoteTempWrites() > remoteTempWritesBefore; }, 30000);
+    const uint32_t remoteTemp_ms = clock.now() - remoteTempStart;
+    ok &= remoteTempSent;
+
+    // 6. a reading between two half degrees: time average of what the unit sees over 10 minutes
+    const float remoteReading = 22.3f;
+    stack.controlFlow().setRemoteTemperature(remoteReading);
+    double remoteSum = 0;
+    const uint32_t remoteAverageTicks = 600000;
+    for (uint32_t t = 0; t < remoteAverageTicks; t++) {
+        stack.run(1);
+        remoteSum += emulator.unit().remoteTemperature;
+    }
+    const float remoteAverage = static_cast<float>(remoteSum / remoteAverageTicks);
+    const uint32_t remoteTempWrites = emulator.getRemoteTempWrites() - remoteTempWritesBefore;
+
+    // 7. outage then recovery: time from the unit answering again to the next complete cycle with fresh data
+    emulator.setSilent(true);
+    stack.run(outage_ms);
+    emulator.setSilent(false);
+    const uint32_t repliesBefore = emulator.getRepliesSent();
+    const size_t cyclesBefore = cycleTimes.size();
+    const uint32_t recoveryStart = clock.now();
+    const bool recovered = stack.runUntil([&]() {
+        return emulator.getRepliesSent() > repliesBefore && cycleTimes.size() > cyclesBefore && stack.isConnected();
+        }, 120000);
+    const uint32_t recovery_ms = clock.now() - recoveryStart;
+    ok &= recovered;
+
+    uint64_t total = 0;
+    uint32_t worst = 0;
+    const size_t steadyCount = std::min<size_t>(cycles, cycleTimes.size());
+    for (size_t i = 0; i < steadyCount; i++) {
+        total += cycleTimes[i];
+        worst = std::max(worst, cycleTimes[i]);
+    }
+
+    std::printf("connect            : %s in %u ms\n", connected ? "OK" : "FAILED", static_cast<unsigned int>(connect_ms));
+    std::printf("cycles             : %u in %u ms\n", static_cast<unsigned int>(steadyCount), static_cast<unsigned int>(steadyElapsed));
+    std::printf("cycle time         : avg %u ms, max %u ms\n",
+        static_cast<unsigned int>(steadyCount ? total / steadyCount : 0), static_cast<unsigned int>(worst));
+    std::printf("control write      : %s in %u ms\n", written ? "OK" : "FAILED", static_cast<unsigned int>(write_ms));
+    std::printf("control confirmed  : %s in %u ms\n", confirmed ? "OK" : "FAILED", static_cast<unsigned int>(confirm_ms));
+    std::printf("mid-cycle write    : %s in %u ms\n", midCycleWritten ? "OK" : "FAILED", static_cast<unsigned int>(midCycle_ms));
+    std::printf("remote temp push   : %s in %u ms\n", remoteTempSent ? "OK" : "FAILED", static_cast<unsigned int>(remoteTemp_ms));
+    std::printf("remote temp average: %.2f for a %.2f reading, %u writes\n", remoteAverage, remoteReading,
+        static_cast<unsigned int>(remoteTempWrites));
+    std::printf("recovery           : %s in %u ms after a %u ms outage\n", recovered ? "OK" : "FAILED",
+        static_cast<unsigned int>(recovery_ms), static_cast<unsigned int>(outage_ms));
+    std::printf("unit frames        : %u received, %u invalid\n",
+        static_cast<unsigned int>(emulator.getFramesReceived()), static_cast<unsigned int>(emulator.getBadFrames()));
+    std::printf("unit replies       : %u sent, %u dropped, %u corrupted, %u slowed\n",
+        static_cast<unsigned int>(emulator.getRepliesSent()), static_cast<unsigned int>(emulator.getRepliesDropped()),
+        static_cast<unsigned int>(emulator.getRepliesCorrupted()), static_cast<unsigned int>(emulator.getRepliesSlowed()));
+    std::printf("decoder resyncs    : %u (%u bytes dropped)\n",
+        static_cast<unsigned int>(stack.connection().getResyncCount()), static_cast<unsigned int>(stack.connection().getDroppedBytes()));
+    uint32_t writesSent = 0, writesAcked = 0, writesRetransmitted = 0, writesLost = 0;
+    for (uint8_t i = 0; i < devicestate::WriteType_Count; i++) {
+        const devicestate::WriteStats& writeStats = stack.connection().getWriteTracker().getStats(static_cast<devicestate::WriteType>(i));
+        writesSent += writeStats.sent;
+        writesAcked += writeStats.acked;
+        writesRetransmitted += writeStats.retransmitted;
+        writesLost += writeStats.lost;
+    }
+    std::printf("writes             : %u sent, %u acked, %u retransmitted, %u lost\n",
+        static_cast<unsigned int>(writesSent), static_cast<unsigned int>(writesAcked),
+        static_cast<unsigned int>(writesRetransmitted), static_cast<unsigned int>(writesLost));
+    std::printf("sensor publishes   : %u\n", static_cast<unsigned int>(sensors.publishCount()));
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+#include "cn105_emulator.h"
+
+#include <cmath>
+
+#include "Globals.h"
+#include "cn105_utils.h"
+#include "esphome.h"
+
+namespace host {
+
+    static const char* TAG = "Emulator"; // Logging tag
+
+    EmulatorIODevice::EmulatorIODevice(const EmulatorConfig& config) : config_(config), rng_(config.seed ? config.seed : 1) {}
+
+    uint32_t EmulatorIODevice::random() {
+        // xorshift32, deterministic for a given seed
+        this->rng_ ^= this->rng_ << 13;
+        this->rng_ ^= this->rng_ >> 17;
+        this->rng_ ^= this->rng_ << 5;
+        return this->rng_;
+    }
+
+    bool EmulatorIODevice::chance(uint16_t permille) {
+        return permille > 0 && (this->random() % 1000) < permille;
+    }
+
+    bool EmulatorIODevice::begin() {
+        this->rxFrame_.clear();
+        this->txBuffer_.clear();
+        this->pending_.clear();
+        this->lastSimulationMs_ = CUSTOM_MILLIS;
+        return true;
+    }
+
+    void EmulatorIODevice::write(uint8_t byte) {
+        if (this->rxFrame_.empty() && byte != 0xFC) {
+            return;
+        }
+        this->rxFrame_.push_back(byte);
+        if (this->rxFrame_.size() >= 5 && this->rxFrame_.size() == static_cast<size_t>(this->rxFrame_[4]) + 6) {
+            this->onFrame(this->rxFrame_);
+            this->rxFrame_.clear();
+        }
+    }
+
+    void EmulatorIODevice::write_array(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            this->write(data[i]);
+        }
+    }
+
+    void EmulatorIODevice::releaseDueReplies() {
+        const uint32_t now = CUSTOM_MILLIS;
+        this->simulate(now - this->lastSimulationMs_);
+        this->lastSimulationMs_ = now;
+
+        // replies go out in deadline order, a slow reply holds the line for the ones behind it
+        while (!this->pending_.empty() && static_cast<int32_t>(now - this->pending_.front().due_ms) >= 0) {
+            const std::vector<uint8_t>& bytes = this->pending_.front().bytes;
+            this->txBuffer_.insert(this->txBuffer_.end(), bytes.begin(), bytes.end());
+            this->pending_.erase(this->pending_.begin());
+        }
+    }
+
+    int EmulatorIODevice::available() {
+        this->releaseDueReplies();
+        return static_cast<int>(this->txBuffer_.size());
+    }
+
+    bool EmulatorIODevice::read(uint8_t* byte) {
+        this->releaseDueReplies();
+        if (this->txBuffer_.empty()) {
+            return false;
+        }
+        *byte = this->txBuffer_.front();
+        this->txBuffer_.pop_front();
+        return true;
+    }
+
+    size_t EmulatorIODevice::read_array(uint8_t* data, size_t len) {
+        this->releaseDueReplies();
+        if (this->txBuffer_.size() < len) {
+            return 0;
+        }
+        for (size_t i = 0; i < len; i++) {
+            data[i] = this->txBuffer_.front();
+            this->txBuffer_.pop_front();
+        }
+        return len;
+    }
+
+    void EmulatorIODevice::simulate(uint32_t elapsed_ms) {
+        EmulatedUnit& unit = this->unit_;
+        const bool heating = (unit.mode == 0x01);
+        const float error = unit.targetTemperature - unit.roomTemperature;
+        unit.operating = unit.power == 0x01 && (heating ? error > 0.25f : error < -0.25f);
+        unit.compressorFrequency = unit.operating ? static_cast<uint8_t>(20 + std::fmin(std::fabs(error) * 20.0f, 60.0f)) : 0;
+        unit.inputPower = unit.operating ? static_cast<uint16_t>(unit.compressorFrequency * 12) : (unit.power ? 15 : 3);
+
+        // about 1 °C per 10 minutes of compressor time, slow loss towards outside otherwise
+        const float minutes = elapsed_ms / 60000.0f;
+        if (unit.operating) {
+            unit.roomTemperature += (heating ? 0.1f : -0.1f) * minutes;
+        } else {
+            unit.roomTemperature += (unit.outsideTemperature - unit.roomTemperature) * 0.001f * minutes;
+        }
+    }
+
+    void EmulatorIODevice::reply(uint8_t command, const uint8_t* data, uint8_t dataLength) {
+        std::vector<uint8_t> bytes = { 0xFC, command, 0x01, 0x30, dataLength };
+        bytes.insert(bytes.end(), data, data + dataLength);
+        bytes.push_back(devicestate::checkSum(bytes.data(), static_cast<int>(bytes.size())));
+
+        if (this->silent_ || this->chance(this->config_.drop_permille)) {
+            this->repliesDropped_++;
+            return;
+        }
+        if (this->chance(this->config_.corrupt_permille)) {
+            const size_t index = 1 + this->random() % (bytes.size() - 1);
+            bytes[index] ^= static_cast<uint8_t>(1u << (this->random() % 8));
+            this->repliesCorrupted_++;
+        }
+
+        uint32_t delay = this->config_.response_delay_ms;
+        if (this->config_.jitter_ms > 0) {
+            delay += this->random() % (this->config_.jitter_ms + 1);
+        }
+        if (this->chance(this->config_.slow_permille)) {
+            delay += this->config_.slow_delay_ms;
+            this->repliesSlowed_++;
+        }
+
+        uint32_t due = CUSTOM_MILLIS + delay;
+        if (!this->pending_.empty() && static_cast<int32_t>(this->pending_.back().due_ms - due) > 0) {
+            due = this->pending_.back().due_ms;
+        }
+        this->pending_.push_back(PendingReply{ due, std::move(bytes) });
+        this->repliesSent_++;
+    }
+
+    void EmulatorIODevice::buildInfo(uint8_t code, uint8_t* data) {
+        const EmulatedUnit& unit = this->unit_;
+        data[0] = code;
+        switch (code) {
+        case 0x02: {
+            data[3] = unit.power;
+            data[4] = unit.mode;
+            const float clamped = std::fmin(std::fmax(unit.targetTemperature, 16.0f), 31.0f);
+            data[5] = static_cast<uint8_t>(31 - static_cast<int>(clamped));
+            data[6] = unit.fan;
+            data[7] = unit.vane;
+            data[10] = unit.wideVane;
+            data[11] = static_cast<uint8_t>(std::lround(unit.targetTemperature * 2) + 128);
+            break;
+        }
+        case 0x03: {
+            const float room = unit.remoteTemperature > 0 ? unit.remoteTemperature : unit.roomTemperature;
+            const float clamped = std::fmin(std::fmax(room, 10.0f), 41.0f);
+            data[3] = static_cast<uint8_t>(static_cast<int>(clamped) - 10);
+            data[5] = static_cast<uint8_t>(std::lround(unit.outsideTemperature * 2) + 128);
+            data[6] = static_cast<uint8_t>(std::lround(room * 2) + 128);
+            data[11] = static_cast<uint8_t>(unit.runtimeMinutes >> 16);
+            data[12] = static_cast<uint8_t>(unit.runtimeMinutes >> 8);
+            data[13] = static_cast<uint8_t>(unit.runtimeMinutes);
+            break;
+        }
+        case 0x06:
+            data[3] = unit.compressorFrequency;
+            data[4] = unit.operating ? 1 : 0;
+            data[5] = static_cast<uint8_t>(unit.inputPower >> 8);
+            data[6] = static_cast<uint8_t>(unit.inputPower);
+            data[7] = static_cast<uint8_t>(unit.energyDeciKWh >> 8);
+            data[8] = static_cast<uint8_t>(unit.energyDeciKWh);
+            break;
+        case 0x09:
+            data[4] = unit.power ? 0x00 : 0x01;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void EmulatorIODevice::applySettings(const std::vector<uint8_t>& frame) {
+        EmulatedUnit& unit = this->unit_;
+        const uint8_t flags1 = frame[6];
+        const uint8_t flags2 = frame[7];
+        if (flags1 & 0x01) unit.power = frame[8];
+        if (flags1 & 0x02) unit.mode = frame[9];
+        if (flags1 & 0x04) {
+            unit.targetTemperature = frame[19] != 0 ? (frame[19] - 128) / 2.0f : static_cast<float>(31 - frame[10]);
+        }
+        if (flags1 & 0x08) unit.fan = frame[11];
+        if (flags1 & 0x10) unit.vane = frame[12];
+        if (flags2 & 0x01) unit.wideVane = frame[18];
+        this->settingsWrites_++;
+        this->lastSettingsWriteMs_ = CUSTOM_MILLIS;
+        ESP_LOGD(TAG, "settings applied: power %02X mode %02X target %.1f fan %02X vane %02X wideVane %02X",
+            unit.power, unit.mode, unit.targetTemperature, unit.fan, unit.vane, unit.wideVane);
+    }
+
+    void EmulatorIODevice::onFrame(std::vector<uint8_t>& frame) {
+        this->framesReceived_++;
+        if (frame[2] != 0x01 || frame[3] != 0x30 ||
+            devicestate::checkSum(frame.data(), static_cast<int>(frame.size()) - 1) != frame.back()) {
+            this->badFrames_++;
+            ESP_LOGW(TAG, "ignoring invalid frame (cmd 0x%02X)", frame[1]);
+            return;
+        }
+
+        const uint8_t command = frame[1];
+        uint8_t data[16] = {};
+
+        if (command == 0x5A || command == 0x5B) {
+            this->connected_ = true;
+            this->reply(command + 0x20, data, 0);
+            return;
+        }
+        if (!this->connected_) {
+            return;
+        }
+
+        if (command == 0x42 && frame.size() > 6) {
+            this->buildInfo(frame[5], data);
+            this->reply(0x62, data, 0x10);
+        } else if (command == 0x41 && frame.size() >= 22) {
+            switch (frame[5]) {
+            case 0x01:
+                this->applySettings(frame);
+                break;
+            case 0x07:
+                this->unit_.remoteTemperature = frame[6] == 0x01 ? (frame[8] - 128) / 2.0f : 0.0f;
+                this->remoteTempWrites_++;
+                break;
+            default:
+                break;
+            }
+            this->reply(0x61, data, 0x10);
+        }
+    }
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "io_device.h"
+
+namespace host {
+
+    struct EmulatorConfig {
+        uint32_t response_delay_ms = 60;    // time between the end of a request and the start of the reply
+        uint32_t jitter_ms = 20;            // uniform extra delay in [0, jitter_ms]
+        uint16_t drop_permille = 0;         // replies never sent
+        uint16_t corrupt_permille = 0;      // replies with one bit flipped
+        uint16_t slow_permille = 0;         // replies delayed by slow_delay_ms on top
+        uint32_t slow_delay_ms = 1500;
+        uint32_t seed = 1;                  // error injection and jitter are deterministic for a seed
+    };
+
+    /**
+     * State of the emulated indoor unit, raw CN105 encodings where the protocol uses them.
+     */
+    struct EmulatedUnit {
+        uint8_t power = 0x00;               // POWER[]
+        uint8_t mode = 0x01;                // MODE[] (HEAT)
+        float targetTemperature = 21.0f;
+        uint8_t fan = 0x00;                 // FAN[]
+        uint8_t vane = 0x00;                // VANE[]
+        uint8_t wideVane = 0x03;            // WIDEVANE[]
+        float roomTemperature = 19.0f;
+        float remoteTemperature = 0.0f;     // 0 while the internal sensor is used
+        float outsideTemperature = 8.0f;
+        bool operating = false;
+        uint8_t compressorFrequency = 0;
+        uint16_t inputPower = 0;
+        uint16_t energyDeciKWh = 0;
+        uint32_t runtimeMinutes = 0;
+    };
+
+    /**
+     * @class EmulatorIODevice
+     * @brief Stateful software indoor unit behind IIODevice.
+     *
+     * Answers CONNECT (0x5A/0x5B), info requests 0x42 (0x02 settings, 0x03 room
+     * temperature, 0x06 status, 0x09 standby, anything else with an empty
+     * payload) and set requests 0x41 (0x01 settings, 0x07 remote temperature,
+     * other codes only acknowledged). Frames are ignored until CONNECT and when
+     * their checksum is wrong, like the real unit. Replies are scheduled on the
+     * VirtualClock with the configured delay and error injection.
+     */
+    class EmulatorIODevice : public devicestate::IIODevice {
+    public:
+        explicit EmulatorIODevice(const EmulatorConfig& config = EmulatorConfig());
+
+        bool begin() override;
+        void write(uint8_t byte) override;
+        void write_array(const uint8_t* data, size_t len) override;
+        int available() override;
+        bool read(uint8_t* byte) override;
+        size_t read_array(uint8_t* data, size_t len) override;
+
+        EmulatorConfig& config() { return this->config_; }
+        EmulatedUnit& unit() { return this->unit_; }
+
+        // a silent unit receives but never answers (unplugged cable, unit rebooting)
+        void setSilent(bool silent) { this->silent_ = silent; }
+        // drop the handshake, the next frames are ignored until a new CONNECT
+        void disconnect() { this->connected_ = false; }
+
+        // thermal model: the room drifts towards the target while the compressor runs
+        void simulate(uint32_t elapsed_ms);
+
+        uint32_t getFramesReceived() const { return this->framesReceived_; }
+        uint32_t getBadFrames() const { return this->badFrames_; }
+        uint32_t getRepliesSent() const { return this->repliesSent_; }
+        uint32_t getRepliesDropped() const { return this->repliesDropped_; }
+        uint32_t getRepliesCorrupted() const { return this->repliesCorrupted_; }
+        uint32_t getRepliesSlowed() const { return this->repliesSlowed_; }
+        uint32_t getSettingsWrites() const { return this->settingsWrites_; }
+        uint32_t getRemoteTempWrites() const { return this->remoteTempWrites_; }
+        uint32_t getLastSettingsWriteMs() const { return this->lastSettingsWriteMs_; }
+
+    private:
+        struct PendingReply {
+            uint32_t due_ms;
+            std::vector<uint8_t> bytes;
+        };
+
+        EmulatorConfig config_;
+        EmulatedUnit unit_;
+        bool connected_ = false;
+        bool silent_ = false;
+        uint32_t rng_;
+
+        std::vector<uint8_t> rxFrame_;       // frame being written by the stack
+        std::vector<PendingReply> pending_;
+        std::deque<uint8_t> txBuffer_;       // reply bytes readable by the stack
+        uint32_t lastSimulationMs_ = 0;
+
+        uint32_t framesReceived_ = 0;
+        uint32_t badFrames_ = 0;
+        uint32_t repliesSent_ = 0;
+        uint32_t repliesDropped_ = 0;
+        uint32_t repliesCorrupted_ = 0;
+        uint32_t repliesSlowed_ = 0;
+        uint32_t settingsWrites_ = 0;
+        uint32_t remoteTempWrites_ = 0;
+        uint32_t lastSettingsWriteMs_ = 0;
+
+        uint32_t random();
+        bool chance(uint16_t permille);
+        void releaseDueReplies();
+        void onFrame(std::vector<uint8_t>& frame);
+        void reply(uint8_t command, const uint8_t* data, uint8_t dataLength);
+        void applySettings(const std::vector<uint8_t>& frame);
+        void buildInfo(uint8_t code, uint8_t* data);
+    };
+
+}
@@ -0,0 +1,94 @@
+/**
+ * cn105_replay
+ *
+ * Replays a CN105 capture (FrameCapture dump, see dump_frames()) through the
+ * real protocol core on the host and reports how the transmitted frames
+ * compare with the recording.
+ *
+ * usage: cn105_replay <capture> [--timed] [--log-level <0..7>] [--update-interval <ms>] [--tail <ms>] [--strict]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "host_stack.h"
+#include "replay_io_device.h"
+#include "virtual_clock.h"
+
+#include "esphome.h"
+
+static void usage() {
+    std::fprintf(stderr, "usage: cn105_replay <capture> [--timed] [--log-level <0..7>] [--update-interval <ms>] [--tail <ms>] [--strict]\n");
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    bool reactive = true;
+    bool strict = false;
+    uint32_t tail_ms = 1000;
+    host::HostStackConfig config;
+    int logLevel = ESPHOME_LOG_LEVEL_WARN;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--timed") == 0) {
+            reactive = false;
+        } else if (std::strcmp(arg, "--strict") == 0) {
+            strict = true;
+        } else if (std::strcmp(arg, "--log-level") == 0 && i + 1 < argc) {
+            logLevel = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--update-interval") == 0 && i + 1 < argc) {
+            config.update_interval = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--tail") == 0 && i + 1 < argc) {
+            tail_ms = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (arg[0] != '-' && path.empty()) {
+            path = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (path.empty()) {
+        usage();
+        return 2;
+    }
+
+    esphome::host::set_log_level(logLevel);
+    host::VirtualClock::instance().reset();
+
+    host::ReplayIODevice device(reactive);
+    if (!device.load(path)) {
+        std::fprintf(stderr, "no capture event in %s\n", path.c_str());
+        return 2;
+    }
+
+    host::HostStack stack(&device, config);
+
+    // the connection bootstrap waits 10 s before sending CONNECT, give the replay room for it
+    const uint32_t budget_ms = 60000 + device.getEventCount() * 5000;
+    const auto started = std::chrono::steady_clock::now();
+    const bool done = stack.runUntil([&device]() { return device.finished(); }, budget_ms);
+    stack.run(tail_ms);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    const double wall_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+
+    std::printf("capture events    : %u (%s)\n", static_cast<unsigned int>(device.getEventCount()), done ? "all replayed" : "NOT all replayed");
+    std::printf("virtual time      : %u ms\n", static_cast<unsigned int>(host::VirtualClock::instance().now()));
+    std::printf("RX bytes released : %u\n", static_cast<unsigned int>(device.getRxBytesReleased()));
+    std::printf("TX matched        : %u\n", static_cast<unsigned int>(device.getTxMatched()));
+    std::printf("TX mismatched     : %u\n", static_cast<unsigned int>(device.getTxMismatched()));
+    std::printf("TX past capture   : %u\n", static_cast<unsigned int>(device.getTxUnexpected()));
+    std::printf("decoder resyncs   : %u (%u bytes dropped)\n",
+        static_cast<unsigned int>(stack.connection().getResyncCount()), static_cast<unsigned int>(stack.connection().getDroppedBytes()));
+    std::printf("cycles completed  : %u (last %u ms)\n",
+        static_cast<unsigned int>(stack.getCyclesCompleted()), static_cast<unsigned int>(stack.getLastCycleMs()));
+    std::printf("host wall time    : %.2f ms\n", wall_ms);
+
+    if (!done) {
+        return 1;
+    }
+    return (strict && (device.getTxMismatched() > 0 || device.getTxUnexpected() > 0)) ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+#include "host_stack.h"
+
+#include "virtual_clock.h"
+
+#include "Globals.h"
+#include "esphome.h"
+
+namespace host {
+
+    HostStack::HostStack(devicestate::IIODevice* io_device, const HostStackConfig& config) {
+        this->loopCycle_.init();
+        this->loopCycle_.setUpdateInterval(config.update_interval);
+
+        auto timeoutCallback = [](const char* name, uint32_t timeout_ms, std::function<void()> callback) {
+            VirtualClock::instance().set_timeout(name, timeout_ms, std::move(callback));
+        };
+
+        this->state_ = new devicestate::CN105State();
+        this->connection_ = new devicestate::CN105Connection(
+            io_device,
+            timeoutCallback,
+            [this](bool state) {
+                if (state) {
+                    this->loopCycle_.lastCompleteCycleMs = CUSTOM_MILLIS;
+                    this->state_->resetCurrentSettings();
+                    this->state_->resetCurrentRunStates();
+                }
+            },
+            config.update_interval);
+        this->controlFlow_ = new devicestate::CN105ControlFlow(
+            this->connection_,
+            this->state_,
+            timeoutCallback,
+            [this]() { this->terminateCycle(); },
+            config.debounce_delay,
+            config.remote_temp_timeout);
+        this->state_->getWantedSettings().resetSettings();
+        this->controlFlow_->set_adaptive_polling(config.min_poll_interval, config.max_poll_interval);
+        this->controlFlow_->set_remote_temp_fast_path(config.remote_temp_fast_delta, config.remote_temp_fast_interval);
+        this->controlFlow_->set_remote_temp_dithering(config.remote_temp_dither_interval);
+        this->controlFlow_->registerInfoRequests();
+        this->controlFlow_->set_write_confirm_callback([this](bool applied) {
+            if (this->onWriteConfirmed) {
+                this->onWriteConfirmed(applied);
+            }
+        });
+    }
+
+    HostStack::~HostStack() {
+        delete this->controlFlow_;
+        delete this->connection_;
+        delete this->state_;
+    }
+
+    void HostStack::terminateCycle() {
+        this->loopCycle_.cycleEnded();
+        this->cyclesCompleted_++;
+        this->lastCycleMs_ = CUSTOM_MILLIS - this->loopCycle_.lastCycleStartMs;
+        if (this->onCycleEnd) {
+            this->onCycleEnd();
+        }
+    }
+
+    void HostStack::loop() {
+        this->controlFlow_->loop(this->loopCycle_);
+    }
+
+    void HostStack::run(uint32_t duration_ms, uint32_t tick_ms) {
+        for (uint32_t elapsed = 0; elapsed < duration_ms; elapsed += tick_ms) {
+            this->loop();
+            VirtualClock::instance().advance(tick_ms);
+        }
+    }
+
+    bool HostStack::runUntil(std::function<bool()> done, uint32_t timeout_ms, uint32_t tick_ms) {
+        for (uint32_t elapsed = 0; elapsed < timeout_ms; elapsed += tick_ms) {
+            if (done()) {
+                return true;
+            }
+            this->loop();
+            VirtualClock::instance().advance(tick_ms);
+        }
+        return done();
+    }
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "cn105_connection.h"
+#include "cn105_controlflow.h"
+#include "cn105_state.h"
+#include "cycle_management.h"
+#include "io_device.h"
+
+namespace host {
+
+    struct HostStackConfig {
+        uint32_t update_interval = 2000;
+        uint32_t debounce_delay = 100;
+        uint32_t remote_temp_timeout = 4294967295;
+        uint32_t min_poll_interval = 0;
+        uint32_t max_poll_interval = 0;   // 0: adaptive polling off
+        float remote_temp_fast_delta = devicestate::REMOTE_TEMP_FAST_DELTA_DEFAULT;   // 0: fast path off
+        uint32_t remote_temp_fast_interval = devicestate::REMOTE_TEMP_FAST_INTERVAL_DEFAULT_MS;
+        uint32_t remote_temp_dither_interval = 0;   // 0: dithering off
+    };
+
+    /**
+     * @class HostStack
+     * @brief Wires the real CN105 core (state, connection, control flow, request
+     * scheduler, protocol) to an IIODevice the way MitsubishiHeatPump::setup() does,
+     * with timeouts and retries running on the VirtualClock.
+     */
+    class HostStack {
+    public:
+        HostStack(devicestate::IIODevice* io_device, const HostStackConfig& config = HostStackConfig());
+        ~HostStack();
+
+        // one MitsubishiHeatPump::loop() pass
+        void loop();
+        // calls loop() then advances the virtual clock by tick_ms, for duration_ms
+        void run(uint32_t duration_ms, uint32_t tick_ms = 1);
+        // same, stops early when done() returns true; returns done()
+        bool runUntil(std::function<bool()> done, uint32_t timeout_ms, uint32_t tick_ms = 1);
+
+        devicestate::CN105State& state() { return *this->state_; }
+        devicestate::CN105Connection& connection() { return *this->connection_; }
+        devicestate::CN105ControlFlow& controlFlow() { return *this->controlFlow_; }
+        cycleManagement& loopCycle() { return this->loopCycle_; }
+
+        uint32_t getCyclesCompleted() const { return this->cyclesCompleted_; }
+        uint32_t getLastCycleMs() const { return this->lastCycleMs_; }
+        bool isConnected() { return this->connection_->isConnected(); }
+
+        // called at the end of every completed cycle, after the control flow
+        std::function<void()> onCycleEnd;
+        // called when the read-back of a settings write matched (true) or gave up (false)
+        std::function<void(bool)> onWriteConfirmed;
+
+    private:
+        devicestate::CN105State* state_;
+        devicestate::CN105Connection* connection_;
+        devicestate::CN105ControlFlow* controlFlow_;
+        cycleManagement loopCycle_{};
+
+        uint32_t cyclesCompleted_ = 0;
+        uint32_t lastCycleMs_ = 0;
+
+        void terminateCycle();
+    };
+
+}
@@ -0,0 +1,202 @@
+#include "replay_io_device.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "Globals.h"
+#include "esphome.h"
+
+namespace host {
+
+    static const char* TAG = "Replay"; // Logging tag
+
+    ReplayIODevice::ReplayIODevice(bool reactive) : reactive_(reactive) {}
+
+    bool ReplayIODevice::parseLine(const std::string& line, CaptureEvent& event) {
+        size_t pos = std::string::npos;
+        for (const char* token : { "RX ", "TX " }) {
+            const size_t found = line.find(token);
+            if (found != std::string::npos && (pos == std::string::npos || found < pos)) {
+                pos = found;
+            }
+        }
+        if (pos == std::string::npos) {
+            return false;
+        }
+
+        std::istringstream in(line.substr(pos));
+        std::string direction;
+        unsigned long timestamp = 0;
+        unsigned int length = 0;
+        if (!(in >> direction >> timestamp >> length)) {
+            return false;
+        }
+
+        event.rx = (direction == "RX");
+        event.timestamp_ms = static_cast<uint32_t>(timestamp);
+        event.bytes.clear();
+        std::string hex;
+        while (in >> hex) {
+            if (hex == "...") break;
+            char* end = nullptr;
+            const unsigned long value = std::strtoul(hex.c_str(), &end, 16);
+            if (end == hex.c_str() || *end != '\0' || value > 0xFF) {
+                return false;
+            }
+            event.bytes.push_back(static_cast<uint8_t>(value));
+        }
+        return !event.bytes.empty();
+    }
+
+    bool ReplayIODevice::loadFromString(const std::string& content) {
+        std::istringstream in(content);
+        std::string line;
+        CaptureEvent event;
+        while (std::getline(in, line)) {
+            if (parseLine(line, event)) {
+                this->events_.push_back(event);
+            }
+        }
+        ESP_LOGI(TAG, "%u capture event(s) loaded", static_cast<unsigned int>(this->events_.size()));
+        return !this->events_.empty();
+    }
+
+    bool ReplayIODevice::load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            ESP_LOGE(TAG, "cannot open %s", path.c_str());
+            return false;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        return this->loadFromString(content.str());
+    }
+
+    bool ReplayIODevice::begin() {
+        this->rxBuffer_.clear();
+        this->txFrame_.clear();
+        return true;
+    }
+
+    bool ReplayIODevice::finished() const {
+        return this->cursor_ >= this->events_.size() && this->rxBuffer_.empty();
+    }
+
+    void ReplayIODevice::releaseDueRx() {
+        if (!this->anchored_) {
+            return;
+        }
+        const uint32_t now = CUSTOM_MILLIS;
+        while (this->cursor_ < this->events_.size() && this->events_[this->cursor_].rx) {
+            const CaptureEvent& event = this->events_[this->cursor_];
+            const int32_t offset = static_cast<int32_t>(event.timestamp_ms - this->anchorRecordedMs_);
+            const uint32_t due = this->anchorVirtualMs_ + (offset > 0 ? offset : 0);
+            if (static_cast<int32_t>(now - due) < 0) {
+                return;
+            }
+            this->rxBuffer_.insert(this->rxBuffer_.end(), event.bytes.begin(), event.bytes.end());
+            this->rxBytesReleased_ += event.bytes.size();
+            this->cursor_++;
+        }
+    }
+
+    void ReplayIODevice::onFrameWritten(const std::vector<uint8_t>& frame) {
+        // recorded RX still pending before this write are released first, they were received earlier
+        while (this->cursor_ < this->events_.size() && this->events_[this->cursor_].rx && this->anchored_) {
+            const CaptureEvent& event = this->events_[this->cursor_];
+            this->rxBuffer_.insert(this->rxBuffer_.end(), event.bytes.begin(), event.bytes.end());
+            this->rxBytesReleased_ += event.bytes.size();
+            this->cursor_++;
+        }
+
+        // before the first write, the recording may start with RX (e.g. trailing answers): skip to the first TX
+        if (!this->anchored_) {
+            while (this->cursor_ < this->events_.size() && this->events_[this->cursor_].rx) {
+                this->cursor_++;
+            }
+        }
+
+        // captures taken from a running unit usually miss the handshake: acknowledge it ourselves
+        const bool isConnect = frame.size() > 1 && (frame[1] == 0x5A || frame[1] == 0x5B);
+        const bool connectRecorded = this->cursor_ < this->events_.size() &&
+            this->events_[this->cursor_].bytes.size() > 1 && this->events_[this->cursor_].bytes[1] == frame[1];
+        if (isConnect && !connectRecorded) {
+            static const uint8_t CONNECT_ACK[] = { 0xFC, 0x7A, 0x01, 0x30, 0x00, 0x55 };
+            ESP_LOGI(TAG, "CONNECT not in the capture, acknowledging it");
+            this->rxBuffer_.insert(this->rxBuffer_.end(), CONNECT_ACK, CONNECT_ACK + sizeof(CONNECT_ACK));
+            return;
+        }
+
+        if (this->cursor_ >= this->events_.size()) {
+            this->txUnexpected_++;
+            ESP_LOGW(TAG, "TX beyond the end of the capture (cmd 0x%02X)", frame.size() > 1 ? frame[1] : 0);
+            return;
+        }
+
+        const CaptureEvent& expected = this->events_[this->cursor_];
+        if (expected.bytes == frame) {
+            this->txMatched_++;
+        } else {
+            this->txMismatched_++;
+            ESP_LOGW(TAG, "TX mismatch at event %u: recorded cmd 0x%02X/0x%02X, sent cmd 0x%02X/0x%02X",
+                static_cast<unsigned int>(this->cursor_),
+                expected.bytes.size() > 1 ? expected.bytes[1] : 0, expected.bytes.size() > 5 ? expected.bytes[5] : 0,
+                frame.size() > 1 ? frame[1] : 0, frame.size() > 5 ? frame[5] : 0);
+        }
+
+        if (this->reactive_ || !this->anchored_) {
+            this->anchored_ = true;
+            this->anchorVirtualMs_ = CUSTOM_MILLIS;
+            this->anchorRecordedMs_ = expected.timestamp_ms;
+        }
+        this->cursor_++;
+    }
+
+    void ReplayIODevice::write(uint8_t byte) {
+        // frames always start with 0xFC and carry their data length in byte 4
+        if (byte == 0xFC && !this->txFrame_.empty()) {
+            this->onFrameWritten(this->txFrame_);
+            this->txFrame_.clear();
+        }
+        this->txFrame_.push_back(byte);
+        if (this->txFrame_.size() >= 5 && this->txFrame_.size() == static_cast<size_t>(this->txFrame_[4]) + 6) {
+            this->onFrameWritten(this->txFrame_);
+            this->txFrame_.clear();
+        }
+    }
+
+    void ReplayIODevice::write_array(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            this->write(data[i]);
+        }
+    }
+
+    int ReplayIODevice::available() {
+        this->releaseDueRx();
+        return static_cast<int>(this->rxBuffer_.size());
+    }
+
+    bool ReplayIODevice::read(uint8_t* byte) {
+        this->releaseDueRx();
+        if (this->rxBuffer_.empty()) {
+            return false;
+        }
+        *byte = this->rxBuffer_.front();
+        this->rxBuffer_.pop_front();
+        return true;
+    }
+
+    size_t ReplayIODevice::read_array(uint8_t* data, size_t len) {
+        this->releaseDueRx();
+        if (this->rxBuffer_.size() < len) {
+            return 0;
+        }
+        for (size_t i = 0; i < len; i++) {
+            data[i] = this->rxBuffer_.front();
+            this->rxBuffer_.pop_front();
+        }
+        return len;
+    }
+
+}
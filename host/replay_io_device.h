@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "io_device.h"
+
+namespace host {
+
+    /**
+     * One line of a capture: bytes received from (RX) or sent to (TX) the heatpump.
+     */
+    struct CaptureEvent {
+        bool rx;
+        uint32_t timestamp_ms;
+        std::vector<uint8_t> bytes;
+    };
+
+    /**
+     * @class ReplayIODevice
+     * @brief IIODevice that plays a recorded capture back to CN105Connection and
+     * checks the frames the stack transmits against the recorded TX frames.
+     *
+     * The capture format is the FrameCapture dump ("RX|TX <millis> <length> <hex bytes>"),
+     * anything before the RX/TX token (ESPHome log prefix) is ignored, as are
+     * lines that do not parse. RX bytes may be any length, noise included.
+     *
+     * RX events are released relative to the time the stack really sent the
+     * preceding TX: in reactive mode the anchor moves on every write (the
+     * recorded response delays are kept whatever the stack timing), otherwise
+     * only the first write anchors the whole recording.
+     */
+    class ReplayIODevice : public devicestate::IIODevice {
+    public:
+        explicit ReplayIODevice(bool reactive = true);
+
+        bool load(const std::string& path);
+        bool loadFromString(const std::string& content);
+
+        bool begin() override;
+        void write(uint8_t byte) override;
+        void write_array(const uint8_t* data, size_t len) override;
+        int available() override;
+        bool read(uint8_t* byte) override;
+        size_t read_array(uint8_t* data, size_t len) override;
+
+        bool finished() const;
+        size_t getEventCount() const { return this->events_.size(); }
+        uint32_t getTxMatched() const { return this->txMatched_; }
+        uint32_t getTxMismatched() const { return this->txMismatched_; }
+        uint32_t getTxUnexpected() const { return this->txUnexpected_; }
+        uint32_t getRxBytesReleased() const { return this->rxBytesReleased_; }
+
+    private:
+        bool reactive_;
+        std::vector<CaptureEvent> events_;
+        size_t cursor_ = 0;                 // next event to replay
+
+        bool anchored_ = false;
+        uint32_t anchorVirtualMs_ = 0;      // virtual time of the write the anchor refers to
+        uint32_t anchorRecordedMs_ = 0;     // recorded time of the matching TX
+
+        std::deque<uint8_t> rxBuffer_;
+        std::vector<uint8_t> txFrame_;      // bytes of the frame currently being written
+
+        uint32_t txMatched_ = 0;
+        uint32_t txMismatched_ = 0;
+        uint32_t txUnexpected_ = 0;
+        uint32_t rxBytesReleased_ = 0;
+
+        void releaseDueRx();
+        void onFrameWritten(const std::vector<uint8_t>& frame);
+        static bool parseLine(const std::string& line, CaptureEvent& event);
+    };
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+ * Host-side stand-in for the ESPHome umbrella header.
+ *
+ * Provides only what the CN105 protocol core uses: the ESP_LOGx macros,
+ * millis()/delay() and Component::set_timeout() driven by the host virtual
+ * clock, and RetryResult. Implemented in esphome_shim.cpp.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+
+// everything is compiled in, esphome::host::set_log_level() filters at runtime
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_VERBOSE
+#endif
+
+#define ESP_LOGE(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+
+#define TRUEFALSE(b) ((b) ? "TRUE" : "FALSE")
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+
+namespace esphome {
+
+    uint32_t millis();
+    void delay(uint32_t ms);
+
+    enum class RetryResult { DONE, RETRY };
+
+    class Component {
+    public:
+        virtual ~Component() = default;
+        virtual void setup() {}
+        virtual void loop() {}
+
+    protected:
+        // same semantics as ESPHome: a pending timeout with the same name on this component is replaced
+        void set_timeout(const std::string& name, uint32_t timeout, std::function<void()>&& f);
+        // ESPHome's static-name overload, name must outlive the timeout
+        void set_timeout(const char* name, uint32_t timeout, std::function<void()>&& f);
+        bool cancel_timeout(const std::string& name);
+    };
+
+    namespace host {
+
+        void set_log_level(int level);
+        int get_log_level();
+        void log(int level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    }
+
+}
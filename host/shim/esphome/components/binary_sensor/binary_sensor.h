@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+    namespace binary_sensor {
+
+        /**
+         * Host stand-in for esphome::binary_sensor::BinarySensor: keeps the last
+         * state and counts publications.
+         */
+        class BinarySensor {
+        public:
+            bool state{false};
+            uint32_t publish_count{0};
+
+            void publish_state(bool value) {
+                this->state = value;
+                this->has_state_ = true;
+                this->publish_count++;
+            }
+            bool has_state() const { return this->has_state_; }
+
+        private:
+            bool has_state_{false};
+        };
+
+    }
+}
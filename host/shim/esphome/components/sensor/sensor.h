@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+    namespace sensor {
+
+        /**
+         * Host stand-in for esphome::sensor::Sensor: keeps the last state and
+         * counts publications.
+         */
+        class Sensor {
+        public:
+            float state{NAN};
+            uint32_t publish_count{0};
+
+            void publish_state(float value) {
+                this->state = value;
+                this->has_state_ = true;
+                this->publish_count++;
+            }
+            float get_state() const { return this->state; }
+            bool has_state() const { return this->has_state_; }
+
+        private:
+            bool has_state_{false};
+        };
+
+    }
+}
@@ -0,0 +1,57 @@
+#include "esphome.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "virtual_clock.h"
+
+namespace esphome {
+
+    static int hostLogLevel = ESPHOME_LOG_LEVEL_INFO;
+
+    uint32_t millis() {
+        return ::host::VirtualClock::instance().now();
+    }
+
+    void delay(uint32_t ms) {
+        ::host::VirtualClock::instance().advance(ms);
+    }
+
+    void Component::set_timeout(const std::string& name, uint32_t timeout, std::function<void()>&& f) {
+        ::host::VirtualClock::instance().set_timeout(name, timeout, std::move(f), this);
+    }
+
+    void Component::set_timeout(const char* name, uint32_t timeout, std::function<void()>&& f) {
+        ::host::VirtualClock::instance().set_timeout(name, timeout, std::move(f), this);
+    }
+
+    bool Component::cancel_timeout(const std::string& name) {
+        return ::host::VirtualClock::instance().cancel_timeout(name, this);
+    }
+
+    namespace host {
+
+        void set_log_level(int level) {
+            hostLogLevel = level;
+        }
+
+        int get_log_level() {
+            return hostLogLevel;
+        }
+
+        void log(int level, const char* tag, const char* format, ...) {
+            if (level > hostLogLevel) {
+                return;
+            }
+            static const char LEVEL_LETTERS[] = "-EWICDVV";
+            std::printf("%10u [%c][%s] ", static_cast<unsigned int>(millis()), LEVEL_LETTERS[level], tag);
+            va_list args;
+            va_start(args, format);
+            std::vprintf(format, args);
+            va_end(args);
+            std::printf("\n");
+        }
+
+    }
+
+}
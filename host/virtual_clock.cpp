@@ -0,0 +1,63 @@
+#include "virtual_clock.h"
+
+namespace host {
+
+    VirtualClock& VirtualClock::instance() {
+        static VirtualClock clock;
+        return clock;
+    }
+
+    void VirtualClock::reset(uint32_t start_ms) {
+        this->now_ = start_ms;
+        this->timers_.clear();
+    }
+
+    void VirtualClock::set_timeout(const std::string& name, uint32_t delay_ms, std::function<void()> callback, const void* owner) {
+        this->cancel_timeout(name, owner);
+        if (delay_ms == SCHEDULER_DONT_RUN) {
+            // like esphome's scheduler: only cancels the previous timer of that name
+            return;
+        }
+        this->timers_.push_back(Timer{ owner, name, this->now_ + delay_ms, this->sequence_++, std::move(callback) });
+    }
+
+    bool VirtualClock::cancel_timeout(const std::string& name, const void* owner) {
+        for (auto it = this->timers_.begin(); it != this->timers_.end(); ++it) {
+            if (it->owner == owner && it->name == name) {
+                this->timers_.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool VirtualClock::runNextDue(uint32_t until) {
+        int next = -1;
+        for (size_t i = 0; i < this->timers_.size(); i++) {
+            const Timer& timer = this->timers_[i];
+            if (static_cast<int32_t>(until - timer.deadline) < 0) continue;
+            if (next < 0 || static_cast<int32_t>(timer.deadline - this->timers_[next].deadline) < 0 ||
+                (timer.deadline == this->timers_[next].deadline && timer.sequence < this->timers_[next].sequence)) {
+                next = static_cast<int>(i);
+            }
+        }
+        if (next < 0) {
+            return false;
+        }
+        Timer timer = std::move(this->timers_[next]);
+        this->timers_.erase(this->timers_.begin() + next);
+        if (static_cast<int32_t>(timer.deadline - this->now_) > 0) {
+            this->now_ = timer.deadline;
+        }
+        timer.callback();
+        return true;
+    }
+
+    void VirtualClock::advance(uint32_t ms) {
+        const uint32_t until = this->now_ + ms;
+        while (this->runNextDue(until)) {
+        }
+        this->now_ = until;
+    }
+
+}
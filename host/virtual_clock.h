@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace host {
+
+    // delay meaning "never", as in esphome's scheduler
+    static const uint32_t SCHEDULER_DONT_RUN = 4294967295UL;
+
+    /**
+     * @class VirtualClock
+     * @brief Simulated millisecond clock behind esphome::millis() on the host,
+     * with the set_timeout semantics of esphome::Component.
+     *
+     * A timeout registered under a name already pending for the same owner
+     * replaces it (owner is the esphome::Component, nullptr for free callbacks);
+     * a SCHEDULER_DONT_RUN delay only cancels it.
+     * Nothing advances by itself: tests move time with advance().
+     */
+    class VirtualClock {
+    public:
+        static VirtualClock& instance();
+
+        uint32_t now() const { return this->now_; }
+        void reset(uint32_t start_ms = 0);
+
+        // advances by ms, firing every due timeout in deadline order
+        void advance(uint32_t ms);
+
+        void set_timeout(const std::string& name, uint32_t delay_ms, std::function<void()> callback, const void* owner = nullptr);
+        bool cancel_timeout(const std::string& name, const void* owner = nullptr);
+        size_t pending() const { return this->timers_.size(); }
+
+    private:
+        struct Timer {
+            const void* owner;
+            std::string name;
+            uint32_t deadline;
+            uint64_t sequence;
+            std::function<void()> callback;
+        };
+
+        uint32_t now_ = 0;
+        uint64_t sequence_ = 0;
+        std::vector<Timer> timers_;
+
+        bool runNextDue(uint32_t until);
+    };
+
+}